@@ -0,0 +1,178 @@
+#include "HeadlessContext.hpp"
+#include <cstdio>
+#include <cstring>
+
+#if defined(P2_BENCH_OSMESA)
+#include <GL/osmesa.h>
+#elif defined(P2_BENCH_EGL)
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#else
+#error "HeadlessContext needs P2_BENCH_OSMESA or P2_BENCH_EGL"
+#endif
+
+HeadlessContext::HeadlessContext()
+    : width(0), height(0), framebuffer(0), colorBuffer(0), depthStencilBuffer(0),
+#if defined(P2_BENCH_OSMESA)
+      context(nullptr), pixels(nullptr) {
+#else
+      display(nullptr), context(nullptr), surface(nullptr) {
+#endif
+}
+
+HeadlessContext::~HeadlessContext() {
+    destroy();
+}
+
+const char* HeadlessContext::backend() const {
+#if defined(P2_BENCH_OSMESA)
+    return "osmesa";
+#else
+    return surface == EGL_NO_SURFACE ? "egl-surfaceless" : "egl-pbuffer";
+#endif
+}
+
+#if defined(P2_BENCH_EGL)
+
+// Prefers Mesa's surfaceless platform, which needs no display server at all.
+static EGLDisplay openDisplay() {
+    const char* extensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    if (extensions && strstr(extensions, "EGL_MESA_platform_surfaceless")) {
+        PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+            (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+        if (getPlatformDisplay) {
+            EGLDisplay display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+            if (display != EGL_NO_DISPLAY && eglInitialize(display, NULL, NULL))
+                return display;
+        }
+    }
+    EGLDisplay display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    if (display != EGL_NO_DISPLAY && eglInitialize(display, NULL, NULL))
+        return display;
+    return EGL_NO_DISPLAY;
+}
+
+#endif
+
+bool HeadlessContext::create(int newWidth, int newHeight) {
+    width = newWidth;
+    height = newHeight;
+
+#if defined(P2_BENCH_OSMESA)
+    const int attributes[] = {
+        OSMESA_FORMAT, OSMESA_RGBA,
+        OSMESA_DEPTH_BITS, 24,
+        OSMESA_STENCIL_BITS, 8,
+        OSMESA_PROFILE, OSMESA_CORE_PROFILE,
+        OSMESA_CONTEXT_MAJOR_VERSION, 3,
+        OSMESA_CONTEXT_MINOR_VERSION, 3,
+        0
+    };
+    OSMesaContext osmesa = OSMesaCreateContextAttribs(attributes, NULL);
+    if (!osmesa) {
+        fprintf(stderr, "OSMesaCreateContextAttribs failed\n");
+        return false;
+    }
+    context = osmesa;
+    pixels = new unsigned char[(size_t)width * height * 4];
+    if (!OSMesaMakeCurrent(osmesa, pixels, GL_UNSIGNED_BYTE, width, height)) {
+        fprintf(stderr, "OSMesaMakeCurrent failed\n");
+        return false;
+    }
+#else
+    EGLDisplay eglDisplay = openDisplay();
+    if (eglDisplay == EGL_NO_DISPLAY) {
+        fprintf(stderr, "No EGL display\n");
+        return false;
+    }
+    display = eglDisplay;
+    if (!eglBindAPI(EGL_OPENGL_API)) {
+        fprintf(stderr, "EGL has no desktop OpenGL\n");
+        return false;
+    }
+    const EGLint configAttributes[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8, EGL_ALPHA_SIZE, 8,
+        EGL_NONE
+    };
+    EGLConfig config;
+    EGLint configCount = 0;
+    bool haveConfig = eglChooseConfig(eglDisplay, configAttributes, &config, 1, &configCount) && configCount > 0;
+    if (!haveConfig) {
+        // Surfaceless displays may offer no pbuffer configs; any GL config will do.
+        const EGLint anyAttributes[] = { EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE };
+        haveConfig = eglChooseConfig(eglDisplay, anyAttributes, &config, 1, &configCount) && configCount > 0;
+    }
+    const EGLint contextAttributes[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 3,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+    EGLContext eglContext = eglCreateContext(eglDisplay, haveConfig ? config : (EGLConfig)0, EGL_NO_CONTEXT, contextAttributes);
+    if (eglContext == EGL_NO_CONTEXT) {
+        fprintf(stderr, "eglCreateContext failed (0x%x)\n", eglGetError());
+        return false;
+    }
+    context = eglContext;
+
+    EGLSurface eglSurface = EGL_NO_SURFACE;
+    if (haveConfig) {
+        const EGLint pbufferAttributes[] = { EGL_WIDTH, width, EGL_HEIGHT, height, EGL_NONE };
+        eglSurface = eglCreatePbufferSurface(eglDisplay, config, pbufferAttributes);
+    }
+    surface = eglSurface;
+    if (!eglMakeCurrent(eglDisplay, eglSurface, eglSurface, eglContext)) {
+        fprintf(stderr, "eglMakeCurrent failed (0x%x)\n", eglGetError());
+        return false;
+    }
+#endif
+
+    glewExperimental = true; // Needed for core profile
+    if (glewInit() != GLEW_OK) {
+        fprintf(stderr, "Failed to initialize GLEW\n");
+        return false;
+    }
+    glGetError(); // glewInit leaves GL_INVALID_ENUM behind on core profiles
+
+    glGenFramebuffers(1, &framebuffer);
+    glGenRenderbuffers(1, &colorBuffer);
+    glGenRenderbuffers(1, &depthStencilBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, depthStencilBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthStencilBuffer);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        fprintf(stderr, "Offscreen framebuffer incomplete\n");
+        return false;
+    }
+    glViewport(0, 0, width, height);
+    return true;
+}
+
+void HeadlessContext::destroy() {
+    if (!context)
+        return;
+    if (framebuffer) {
+        glDeleteFramebuffers(1, &framebuffer);
+        glDeleteRenderbuffers(1, &colorBuffer);
+        glDeleteRenderbuffers(1, &depthStencilBuffer);
+        framebuffer = colorBuffer = depthStencilBuffer = 0;
+    }
+#if defined(P2_BENCH_OSMESA)
+    OSMesaDestroyContext((OSMesaContext)context);
+    delete[] pixels;
+    pixels = nullptr;
+#else
+    eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (surface != EGL_NO_SURFACE)
+        eglDestroySurface(display, surface);
+    eglDestroyContext(display, context);
+    eglTerminate(display);
+#endif
+    context = nullptr;
+}
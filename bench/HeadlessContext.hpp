@@ -0,0 +1,39 @@
+#ifndef HEADLESSCONTEXT_HPP
+#define HEADLESSCONTEXT_HPP
+
+#include <GL/glew.h>
+
+// An OpenGL 3.3 core context with no window, for benchmarks on machines
+// without a display. Built against OSMesa (P2_BENCH_OSMESA) or EGL
+// (P2_BENCH_EGL, surfaceless when the driver allows, else a pbuffer); with
+// Mesa either one runs on llvmpipe. Rendering goes to an owned framebuffer
+// with color, depth and stencil, which is left bound, so the same code works
+// whether or not the context has a default framebuffer.
+class HeadlessContext {
+public:
+    HeadlessContext();
+    ~HeadlessContext();
+
+    // Creates the context, makes it current and initializes GLEW. Prints why on failure.
+    bool create(int width, int height);
+    void destroy();
+
+    const char* backend() const;
+
+private:
+    int width, height;
+    GLuint framebuffer;
+    GLuint colorBuffer;
+    GLuint depthStencilBuffer;
+
+#if defined(P2_BENCH_OSMESA)
+    void* context;  // OSMesaContext
+    unsigned char* pixels;
+#elif defined(P2_BENCH_EGL)
+    void* display;  // EGLDisplay
+    void* context;  // EGLContext
+    void* surface;  // EGLSurface, or EGL_NO_SURFACE
+#endif
+};
+
+#endif // HEADLESSCONTEXT_HPP
@@ -0,0 +1,468 @@
+// curve_microbench: times the curve math kernels on their own, away from GL and
+// threads, so SIMD and data layout changes can be judged by the numbers.
+//
+// Each kernel runs for degrees 1..7 (where it has a degree) and batch sizes
+// 1, 10, .. 1M samples. A batch repeats until it has run for --min-time ms; the
+// best of five such runs is reported as ns/sample, samples/s and cycles/sample.
+// Cycles come from the time-stamp counter, which ticks at a fixed reference
+// rate: compare cycles between runs on the same machine only.
+//
+// Results are written one per line so --baseline can read an earlier run back
+// and print the ratio for every matching entry.
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+#include "Tessellator.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_HAS_TSC 1
+#elif defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#define BENCH_HAS_TSC 1
+#endif
+
+namespace {
+
+const int kMaxDegree = 7;
+const int kSplinePoints = 64; // control points of the B-spline kernels
+
+uint64_t readCycles() {
+#ifdef BENCH_HAS_TSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+// Everything a kernel may read. Arrays hold the largest batch; kernels use the first n.
+struct Inputs {
+    glm::vec3 points[kMaxDegree + 1];
+    float weights[kMaxDegree + 1];
+    std::vector<glm::vec3> spline;  // kSplinePoints control points
+    std::vector<float> t;           // parameters in [0, 1]
+    std::vector<glm::vec3> queries; // closest-point targets near the curve
+    CubicSegment cubic;             // points[0..3], for the kernels of Tessellator.hpp
+};
+
+typedef void (*Kernel)(const Inputs& in, size_t n, glm::vec3* out);
+
+// Bernstein basis: C(d,i) (1-t)^(d-i) t^i, powers built incrementally.
+template <int Degree>
+void bernstein(const Inputs& in, size_t n, glm::vec3* out) {
+    float binomial[Degree + 1];
+    binomial[0] = 1.0f;
+    for (int i = 1; i <= Degree; ++i)
+        binomial[i] = binomial[i - 1] * (float)(Degree - i + 1) / (float)i;
+    for (size_t s = 0; s < n; ++s) {
+        float t = in.t[s], u = 1.0f - t;
+        float tPow[Degree + 1], uPow[Degree + 1];
+        tPow[0] = uPow[0] = 1.0f;
+        for (int i = 1; i <= Degree; ++i) {
+            tPow[i] = tPow[i - 1] * t;
+            uPow[i] = uPow[i - 1] * u;
+        }
+        glm::vec3 p(0.0f);
+        for (int i = 0; i <= Degree; ++i)
+            p += (binomial[i] * uPow[Degree - i] * tPow[i]) * in.points[i];
+        out[s] = p;
+    }
+}
+
+template <int Degree>
+void deCasteljau(const Inputs& in, size_t n, glm::vec3* out) {
+    for (size_t s = 0; s < n; ++s) {
+        float t = in.t[s];
+        glm::vec3 p[Degree + 1];
+        for (int i = 0; i <= Degree; ++i)
+            p[i] = in.points[i];
+        for (int level = Degree; level > 0; --level)
+            for (int i = 0; i < level; ++i)
+                p[i] = glm::mix(p[i], p[i + 1], t);
+        out[s] = p[0];
+    }
+}
+
+// n uniform samples, t = 0 .. 1. The difference table comes from Degree + 1
+// exact samples; after that each sample is Degree additions.
+template <int Degree>
+void forwardDifference(const Inputs& in, size_t n, glm::vec3* out) {
+    if (n == 0)
+        return;
+    float h = n > 1 ? 1.0f / (float)(n - 1) : 0.0f;
+    glm::vec3 d[Degree + 1];
+    for (int k = 0; k <= Degree; ++k) {
+        float t = (float)k * h;
+        glm::vec3 p[Degree + 1];
+        for (int i = 0; i <= Degree; ++i)
+            p[i] = in.points[i];
+        for (int level = Degree; level > 0; --level)
+            for (int i = 0; i < level; ++i)
+                p[i] = glm::mix(p[i], p[i + 1], t);
+        d[k] = p[0];
+    }
+    for (int level = 1; level <= Degree; ++level)
+        for (int k = Degree; k >= level; --k)
+            d[k] -= d[k - 1];
+    for (size_t s = 0; s < n; ++s) {
+        out[s] = d[0];
+        for (int k = 0; k < Degree; ++k)
+            d[k] += d[k + 1];
+    }
+}
+
+// Uniform, unclamped B-spline over kSplinePoints control points: find
+// the span, then de Boor. t covers the whole parameter range.
+template <int Degree>
+void bspline(const Inputs& in, size_t n, glm::vec3* out) {
+    const int spans = kSplinePoints - Degree;
+    for (size_t s = 0; s < n; ++s) {
+        float x = in.t[s] * (float)spans;
+        int span = glm::min((int)x, spans - 1);
+        float u = x - (float)span;
+        glm::vec3 p[Degree + 1];
+        for (int i = 0; i <= Degree; ++i)
+            p[i] = in.spline[span + i];
+        // Knots are the integers, so every knot span has length 1.
+        for (int r = 1; r <= Degree; ++r)
+            for (int i = Degree; i >= r; --i) {
+                float alpha = (u + (float)(Degree - i)) / (float)(Degree + 1 - r);
+                p[i] = glm::mix(p[i - 1], p[i], alpha);
+            }
+        out[s] = p[Degree];
+    }
+}
+
+// Rational Bezier: de Casteljau on homogeneous points, one divide at the end.
+template <int Degree>
+void rational(const Inputs& in, size_t n, glm::vec3* out) {
+    for (size_t s = 0; s < n; ++s) {
+        float t = in.t[s];
+        glm::vec4 p[Degree + 1];
+        for (int i = 0; i <= Degree; ++i)
+            p[i] = glm::vec4(in.points[i] * in.weights[i], in.weights[i]);
+        for (int level = Degree; level > 0; --level)
+            for (int i = 0; i < level; ++i)
+                p[i] = glm::mix(p[i], p[i + 1], t);
+        out[s] = glm::vec3(p[0]) / p[0].w;
+    }
+}
+
+// Closest point on the curve to each query: best of 8 uniform samples, then
+// three Newton steps on (B(t) - q) . B'(t) = 0, clamped to [0, 1].
+template <int Degree>
+void closestPoint(const Inputs& in, size_t n, glm::vec3* out) {
+    glm::vec3 d1[Degree], d2[Degree > 1 ? Degree - 1 : 1];
+    for (int i = 0; i < Degree; ++i)
+        d1[i] = (float)Degree * (in.points[i + 1] - in.points[i]);
+    for (int i = 0; i + 1 < Degree; ++i)
+        d2[i] = (float)(Degree - 1) * (d1[i + 1] - d1[i]);
+
+    auto evaluate = [](const glm::vec3* pts, int degree, float t) {
+        glm::vec3 p[Degree + 1];
+        for (int i = 0; i <= degree; ++i)
+            p[i] = pts[i];
+        for (int level = degree; level > 0; --level)
+            for (int i = 0; i < level; ++i)
+                p[i] = glm::mix(p[i], p[i + 1], t);
+        return p[0];
+    };
+
+    for (size_t s = 0; s < n; ++s) {
+        const glm::vec3& q = in.queries[s];
+        float best = 0.0f, bestDistance = 1e30f;
+        for (int k = 0; k <= 7; ++k) {
+            float t = (float)k / 7.0f;
+            glm::vec3 e = evaluate(in.points, Degree, t) - q;
+            float distance = glm::dot(e, e);
+            if (distance < bestDistance) {
+                bestDistance = distance;
+                best = t;
+            }
+        }
+        float t = best;
+        for (int iteration = 0; iteration < 3; ++iteration) {
+            glm::vec3 e = evaluate(in.points, Degree, t) - q;
+            glm::vec3 first = evaluate(d1, Degree - 1, t);
+            glm::vec3 second = Degree > 1 ? evaluate(d2, Degree - 2, t) : glm::vec3(0.0f);
+            float f = glm::dot(e, first);
+            float df = glm::dot(first, first) + glm::dot(e, second);
+            if (df <= 0.0f)
+                break;
+            t = glm::clamp(t - f / df, 0.0f, 1.0f);
+        }
+        out[s] = evaluate(in.points, Degree, t);
+    }
+}
+
+// The kernels the application actually runs (Tessellator.hpp), cubic only.
+void segmentEvaluate(const Inputs& in, size_t n, glm::vec3* out) {
+    for (size_t s = 0; s < n; ++s)
+        out[s] = evaluateSegment(in.cubic, in.t[s]);
+}
+
+void segmentTessellate(const Inputs& in, size_t n, glm::vec3* out) {
+    if (n > 0)
+        tessellateSegment(in.cubic, (int)glm::max(n - 1, (size_t)1), false, n == 1, out);
+}
+
+struct KernelInfo {
+    const char* name;
+    Kernel byDegree[kMaxDegree + 1]; // [0] unused; null where a degree is not covered
+};
+
+template <template <int> class Wrap>
+KernelInfo allDegrees(const char* name) {
+    KernelInfo info = { name, { nullptr, Wrap<1>::run, Wrap<2>::run, Wrap<3>::run, Wrap<4>::run, Wrap<5>::run,
+                                Wrap<6>::run, Wrap<7>::run } };
+    return info;
+}
+
+#define BENCH_WRAP(Name, Function) \
+    template <int D> struct Name { static void run(const Inputs& in, size_t n, glm::vec3* out) { Function<D>(in, n, out); } }
+BENCH_WRAP(BernsteinWrap, bernstein);
+BENCH_WRAP(DeCasteljauWrap, deCasteljau);
+BENCH_WRAP(ForwardDifferenceWrap, forwardDifference);
+BENCH_WRAP(BSplineWrap, bspline);
+BENCH_WRAP(RationalWrap, rational);
+BENCH_WRAP(ClosestPointWrap, closestPoint);
+#undef BENCH_WRAP
+
+std::vector<KernelInfo> kernels() {
+    std::vector<KernelInfo> list;
+    list.push_back(allDegrees<BernsteinWrap>("bernstein"));
+    list.push_back(allDegrees<DeCasteljauWrap>("de_casteljau"));
+    list.push_back(allDegrees<ForwardDifferenceWrap>("forward_difference"));
+    list.push_back(allDegrees<BSplineWrap>("bspline"));
+    list.push_back(allDegrees<RationalWrap>("rational"));
+    list.push_back(allDegrees<ClosestPointWrap>("closest_point"));
+    KernelInfo evaluate = { "segment_evaluate", { nullptr, nullptr, nullptr, segmentEvaluate } };
+    KernelInfo tessellate = { "segment_tessellate", { nullptr, nullptr, nullptr, segmentTessellate } };
+    list.push_back(evaluate);
+    list.push_back(tessellate);
+    return list;
+}
+
+struct Result {
+    std::string kernel;
+    int degree;
+    size_t batch;
+    double nsPerSample;
+    double samplesPerSecond;
+    double cyclesPerSample;
+};
+
+struct Options {
+    std::string kernel;   // empty for all
+    int degree = 0;       // 0 for all
+    size_t maxBatch = 1000000;
+    double minTimeMs = 20.0;
+    std::string out;
+    std::string baseline;
+    double threshold = 1.10; // slower than baseline by more than this fails --baseline
+};
+
+volatile float sink;
+
+Result measure(const KernelInfo& kernel, int degree, size_t batch, const Inputs& in, std::vector<glm::vec3>& out,
+               double minTimeMs) {
+    typedef std::chrono::steady_clock Clock;
+    Kernel run = kernel.byDegree[degree];
+    run(in, batch, out.data()); // warm caches and page in the output
+
+    // Calls per timed run so that one run lasts about minTimeMs.
+    size_t calls = 1;
+    for (;;) {
+        Clock::time_point start = Clock::now();
+        for (size_t c = 0; c < calls; ++c)
+            run(in, batch, out.data());
+        double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        if (ms >= minTimeMs || calls >= ((size_t)1 << 40))
+            break;
+        calls = ms > 0.0 ? glm::max(calls * 2, (size_t)(calls * minTimeMs / ms * 1.1)) : calls * 16;
+    }
+
+    double bestNs = 1e300, bestCycles = 1e300;
+    for (int repeat = 0; repeat < 5; ++repeat) {
+        uint64_t cycles = readCycles();
+        Clock::time_point start = Clock::now();
+        for (size_t c = 0; c < calls; ++c)
+            run(in, batch, out.data());
+        double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        cycles = readCycles() - cycles;
+        bestNs = glm::min(bestNs, ns);
+        bestCycles = glm::min(bestCycles, (double)cycles);
+        sink = out[batch - 1].x;
+    }
+
+    double samples = (double)calls * (double)batch;
+    Result result;
+    result.kernel = kernel.name;
+    result.degree = degree;
+    result.batch = batch;
+    result.nsPerSample = bestNs / samples;
+    result.samplesPerSecond = samples / (bestNs * 1e-9);
+    result.cyclesPerSample = bestCycles / samples;
+    return result;
+}
+
+const char* kResultFormat =
+    "  {\"kernel\": \"%s\", \"degree\": %d, \"batch\": %zu, \"ns_per_sample\": %.4f, \"samples_per_s\": %.0f, \"cycles_per_sample\": %.3f}";
+
+// Reads the result lines of an earlier run; anything else in the file is skipped.
+bool readBaseline(const std::string& path, std::map<std::string, Result>& baseline) {
+    FILE* file = fopen(path.c_str(), "r");
+    if (!file) {
+        fprintf(stderr, "Could not open baseline %s\n", path.c_str());
+        return false;
+    }
+    char line[512];
+    while (fgets(line, sizeof(line), file)) {
+        char name[64];
+        Result r;
+        if (sscanf(line, " {\"kernel\": \"%63[^\"]\", \"degree\": %d, \"batch\": %zu, \"ns_per_sample\": %lf, "
+                         "\"samples_per_s\": %lf, \"cycles_per_sample\": %lf}",
+                   name, &r.degree, &r.batch, &r.nsPerSample, &r.samplesPerSecond, &r.cyclesPerSample) != 6)
+            continue;
+        r.kernel = name;
+        baseline[r.kernel + "/" + std::to_string(r.degree) + "/" + std::to_string(r.batch)] = r;
+    }
+    fclose(file);
+    return true;
+}
+
+void usage() {
+    fprintf(stderr,
+            "usage: curve_microbench [--kernel NAME] [--degree D] [--max-batch N] [--min-time MS]\n"
+            "                        [--out FILE] [--baseline FILE] [--threshold RATIO]\n"
+            "kernels: bernstein de_casteljau forward_difference bspline rational closest_point\n"
+            "         segment_evaluate segment_tessellate (degree 3 only)\n");
+}
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!value) {
+            usage();
+            return false;
+        }
+        if (strcmp(arg, "--kernel") == 0) options.kernel = value;
+        else if (strcmp(arg, "--degree") == 0) options.degree = atoi(value);
+        else if (strcmp(arg, "--max-batch") == 0) options.maxBatch = (size_t)strtoull(value, nullptr, 10);
+        else if (strcmp(arg, "--min-time") == 0) options.minTimeMs = atof(value);
+        else if (strcmp(arg, "--out") == 0) options.out = value;
+        else if (strcmp(arg, "--baseline") == 0) options.baseline = value;
+        else if (strcmp(arg, "--threshold") == 0) options.threshold = atof(value);
+        else {
+            usage();
+            return false;
+        }
+        ++i;
+    }
+    if (options.degree < 0 || options.degree > kMaxDegree || options.maxBatch < 1 || options.minTimeMs <= 0.0) {
+        usage();
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options))
+        return 2;
+#ifndef __OPTIMIZE__
+    fprintf(stderr, "warning: built without optimization, timings are not representative\n");
+#endif
+
+    std::map<std::string, Result> baseline;
+    if (!options.baseline.empty() && !readBaseline(options.baseline, baseline))
+        return 1;
+
+    // Fixed seed: every run times the same data.
+    std::mt19937 engine(12345);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    Inputs in;
+    for (int i = 0; i <= kMaxDegree; ++i) {
+        in.points[i] = glm::vec3((float)i, 2.0f * unit(engine) - 1.0f, 0.0f);
+        in.weights[i] = 0.5f + unit(engine);
+    }
+    for (int i = 0; i < 4; ++i)
+        in.cubic.p[i] = in.points[i];
+    for (int i = 0; i < kSplinePoints; ++i)
+        in.spline.push_back(glm::vec3((float)i, 2.0f * unit(engine) - 1.0f, 0.0f));
+    in.t.resize(options.maxBatch);
+    in.queries.resize(options.maxBatch);
+    for (size_t s = 0; s < options.maxBatch; ++s) {
+        in.t[s] = unit(engine);
+        in.queries[s] = glm::vec3(kMaxDegree * unit(engine), 3.0f * unit(engine) - 1.5f, 0.0f);
+    }
+    std::vector<glm::vec3> out(options.maxBatch);
+
+    FILE* file = stdout;
+    if (!options.out.empty() && !(file = fopen(options.out.c_str(), "w"))) {
+        fprintf(stderr, "Could not write %s\n", options.out.c_str());
+        return 1;
+    }
+
+    std::vector<KernelInfo> list = kernels();
+    int compared = 0, regressions = 0;
+    bool first = true;
+    fprintf(file, "{\n\"tsc\": %s,\n\"results\": [\n",
+#ifdef BENCH_HAS_TSC
+            "true"
+#else
+            "false"
+#endif
+    );
+    for (size_t k = 0; k < list.size(); ++k) {
+        if (!options.kernel.empty() && options.kernel != list[k].name)
+            continue;
+        for (int degree = 1; degree <= kMaxDegree; ++degree) {
+            if (!list[k].byDegree[degree] || (options.degree && degree != options.degree))
+                continue;
+            for (size_t batch = 1; batch <= options.maxBatch; batch *= 10) {
+                Result r = measure(list[k], degree, batch, in, out, options.minTimeMs);
+                fprintf(file, "%s", first ? "" : ",\n");
+                fprintf(file, kResultFormat, r.kernel.c_str(), r.degree, r.batch, r.nsPerSample, r.samplesPerSecond,
+                        r.cyclesPerSample);
+                fflush(file);
+                first = false;
+
+                std::string key = r.kernel + "/" + std::to_string(r.degree) + "/" + std::to_string(r.batch);
+                std::map<std::string, Result>::const_iterator base = baseline.find(key);
+                if (base == baseline.end())
+                    continue;
+                double ratio = r.nsPerSample / base->second.nsPerSample;
+                bool regressed = ratio > options.threshold;
+                compared++;
+                if (regressed)
+                    regressions++;
+                fprintf(stderr, "%-20s degree %d batch %8zu: %9.3f -> %9.3f ns/sample (%.2fx)%s\n", r.kernel.c_str(),
+                        r.degree, r.batch, base->second.nsPerSample, r.nsPerSample, ratio,
+                        regressed ? "  SLOWER" : ratio < 1.0 / options.threshold ? "  faster" : "");
+            }
+        }
+    }
+    fprintf(file, "\n]\n}\n");
+    if (file != stdout)
+        fclose(file);
+
+    if (!options.baseline.empty()) {
+        fprintf(stderr, "%d compared with %s, %d slower than %.2fx\n", compared, options.baseline.c_str(), regressions,
+                options.threshold);
+        return regressions > 0 ? 1 : 0;
+    }
+    return 0;
+}
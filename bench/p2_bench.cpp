@@ -0,0 +1,508 @@
+// p2_bench: renders procedurally generated scenes offscreen and replays a
+// scripted sequence of drags, picks and zooms, then reports frame rate, CPU
+// time per phase and upload volume as JSON. No window or GPU needed.
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include "HeadlessContext.hpp"
+#include "AllocationCounter.hpp"
+#include "FillObject.hpp"
+#include "FrameArena.hpp"
+#include "JobSystem.hpp"
+#include "LineObject.hpp"
+#include "ParallelTessellator.hpp"
+#include "PointsObject.hpp"
+#include "SceneArchive.hpp"
+#include "SceneFile.hpp"
+#include "Tessellator.hpp"
+#include "UploadStats.hpp"
+
+#ifndef P2_SHADER_DIR
+#define P2_SHADER_DIR "."
+#endif
+
+namespace {
+
+struct Options {
+    int curves = 64;
+    int points = 16;
+    int frames = 600;
+    int steps = 16;      // per segment at zoom 1
+    int threads = -1;    // job system workers, < 0 for all hardware threads
+    int width = 1024, height = 768;
+    unsigned seed = 1;
+    int actionFrames = 40; // frames per scripted action
+    PositionFormat pointPositions = PositionFormat::Float;
+    double tileSize = 1.0; // world units, for quantized points
+    std::string scene;      // load the curves from this scene file instead of generating them
+    std::string writeScene; // write the generated curves there
+    std::string writeArchive; // and compressed, there
+    std::string out = "p2_bench.json";
+    std::string shaderDir = P2_SHADER_DIR;
+};
+
+const float kViewHalfWidth = 4.0f, kViewHalfHeight = 3.0f;
+const float kPointSize = 20.0f; // pixels, as in the app
+const int kPickableIds = 254;   // ids 1..254; 255 stands for every later point
+
+const char* pointFormatName(PositionFormat format) {
+    switch (format) {
+    case PositionFormat::Half: return "half";
+    case PositionFormat::Quantized16: return "quantized";
+    default: return "float";
+    }
+}
+
+void usage() {
+    fprintf(stderr,
+            "usage: p2_bench [--curves N] [--points M] [--frames F] [--steps S] [--threads T]\n"
+            "                [--size WxH] [--seed S] [--action-frames K] [--point-format float|half|quantized]\n"
+            "                [--tile-size T] [--scene FILE] [--write-scene FILE] [--write-archive FILE] [--shaders DIR] [--out FILE]\n"
+            "JSON results go to FILE (default p2_bench.json), '-' for stdout.\n");
+}
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!value) {
+            usage();
+            return false;
+        }
+        if (strcmp(arg, "--curves") == 0) options.curves = atoi(value);
+        else if (strcmp(arg, "--points") == 0) options.points = atoi(value);
+        else if (strcmp(arg, "--frames") == 0) options.frames = atoi(value);
+        else if (strcmp(arg, "--steps") == 0) options.steps = atoi(value);
+        else if (strcmp(arg, "--threads") == 0) options.threads = atoi(value);
+        else if (strcmp(arg, "--seed") == 0) options.seed = (unsigned)strtoul(value, nullptr, 10);
+        else if (strcmp(arg, "--action-frames") == 0) options.actionFrames = atoi(value);
+        else if (strcmp(arg, "--shaders") == 0) options.shaderDir = value;
+        else if (strcmp(arg, "--out") == 0) options.out = value;
+        else if (strcmp(arg, "--point-format") == 0 && strcmp(value, "float") == 0) options.pointPositions = PositionFormat::Float;
+        else if (strcmp(arg, "--point-format") == 0 && strcmp(value, "half") == 0) options.pointPositions = PositionFormat::Half;
+        else if (strcmp(arg, "--point-format") == 0 && strcmp(value, "quantized") == 0) options.pointPositions = PositionFormat::Quantized16;
+        else if (strcmp(arg, "--tile-size") == 0) options.tileSize = atof(value);
+        else if (strcmp(arg, "--scene") == 0) options.scene = value;
+        else if (strcmp(arg, "--write-scene") == 0) options.writeScene = value;
+        else if (strcmp(arg, "--write-archive") == 0) options.writeArchive = value;
+        else if (strcmp(arg, "--size") == 0) {
+            if (sscanf(value, "%dx%d", &options.width, &options.height) != 2) {
+                usage();
+                return false;
+            }
+        } else {
+            usage();
+            return false;
+        }
+        ++i;
+    }
+    if (options.curves < 1 || options.points < 3 || options.frames < 1 || options.actionFrames < 1 || !(options.tileSize > 0.0)) {
+        fprintf(stderr, "need at least 1 curve, 3 points per curve, 1 frame and 1 frame per action, and a positive tile size\n");
+        return false;
+    }
+    return true;
+}
+
+// Uniform in [0, 1), the same sequence on every platform for a given seed.
+struct Random {
+    std::mt19937 engine;
+    explicit Random(unsigned seed) : engine(seed) {}
+    float next() { return (float)(engine() >> 8) * (1.0f / 16777216.0f); }
+    int below(int n) { return (int)(engine() % (unsigned)n); }
+};
+
+// Curves on a grid over the view, each a wobbly closed loop.
+void generateScene(const Options& options, Random& random, std::vector<std::vector<glm::vec3> >& curves) {
+    int columns = (int)std::ceil(std::sqrt((double)options.curves * kViewHalfWidth / kViewHalfHeight));
+    int rows = (options.curves + columns - 1) / columns;
+    glm::vec2 cell(2.0f * kViewHalfWidth / columns, 2.0f * kViewHalfHeight / rows);
+    curves.assign(options.curves, std::vector<glm::vec3>());
+    for (int c = 0; c < options.curves; ++c) {
+        glm::vec2 center(-kViewHalfWidth + (c % columns + 0.5f) * cell.x, -kViewHalfHeight + (c / columns + 0.5f) * cell.y);
+        float radius = 0.4f * glm::min(cell.x, cell.y);
+        for (int i = 0; i < options.points; ++i) {
+            float angle = 6.2831853f * (float)i / (float)options.points;
+            float r = radius * (0.6f + 0.4f * random.next());
+            curves[c].push_back(glm::vec3(center + r * glm::vec2(std::cos(angle), std::sin(angle)), 0.0f));
+        }
+    }
+}
+
+struct PhaseTimes {
+    const char* name;
+    std::vector<double> samples;
+};
+
+double percentile(std::vector<double> samples, double p) {
+    if (samples.empty())
+        return 0.0;
+    size_t rank = (size_t)std::ceil(p * samples.size());
+    size_t k = rank > 0 ? rank - 1 : 0;
+    std::nth_element(samples.begin(), samples.begin() + k, samples.end());
+    return samples[k];
+}
+
+void writePhase(FILE* file, const PhaseTimes& phase, bool last) {
+    double sum = 0.0, peak = 0.0;
+    for (size_t i = 0; i < phase.samples.size(); ++i) {
+        sum += phase.samples[i];
+        peak = glm::max(peak, phase.samples[i]);
+    }
+    double mean = phase.samples.empty() ? 0.0 : sum / phase.samples.size();
+    fprintf(file, "    \"%s\": { \"samples\": %zu, \"mean\": %.4f, \"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f }%s\n",
+            phase.name, phase.samples.size(), mean, percentile(phase.samples, 0.5), percentile(phase.samples, 0.95),
+            percentile(phase.samples, 0.99), peak, last ? "" : ",");
+}
+
+// Every curve of a SceneFile or SceneArchive, colors flattened.
+template <typename Scene>
+bool readCurves(const Scene& scene, const std::string& path, std::vector<std::vector<glm::vec3> >& curves,
+                std::vector<glm::vec3>& colors) {
+    curves.resize(scene.curveCount());
+    for (size_t c = 0; c < curves.size(); ++c) {
+        scene.curvePoints(c, curves[c], colors);
+        if (curves[c].size() < 3) {
+            fprintf(stderr, "%s: curve %zu has fewer than 3 points\n", path.c_str(), c);
+            return false;
+        }
+    }
+    if (curves.empty()) {
+        fprintf(stderr, "%s has no curves\n", path.c_str());
+        return false;
+    }
+    return true;
+}
+
+double millisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options))
+        return 2;
+    // Shaders load relative to their directory; keep file arguments relative to where we started.
+    char cwd[4096];
+    if (getcwd(cwd, sizeof(cwd))) {
+        std::string* paths[] = { &options.out, &options.scene, &options.writeScene, &options.writeArchive };
+        for (std::string* path : paths)
+            if (!path->empty() && *path != "-" && (*path)[0] != '/')
+                *path = std::string(cwd) + "/" + *path;
+    }
+    // With --out -, stdout carries only the JSON: anything else printed there,
+    // such as the shader loader's progress, goes to stderr instead.
+    FILE* jsonOut = stdout;
+    if (options.out == "-") {
+        fflush(stdout);
+        int jsonFd = dup(fileno(stdout));
+        if (jsonFd < 0 || dup2(fileno(stderr), fileno(stdout)) < 0 || !(jsonOut = fdopen(jsonFd, "w"))) {
+            fprintf(stderr, "Cannot redirect stdout\n");
+            return 1;
+        }
+    }
+    if (chdir(options.shaderDir.c_str()) != 0) {
+        fprintf(stderr, "Cannot enter shader directory %s\n", options.shaderDir.c_str());
+        return 1;
+    }
+
+    HeadlessContext context;
+    if (!context.create(options.width, options.height))
+        return 1;
+
+    // Same state as the interactive app.
+    glClearColor(0.0f, 0.0f, 0.4f, 0.0f);
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_LEQUAL);
+    glEnable(GL_CULL_FACE);
+    glPointSize(kPointSize);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    Random random(options.seed);
+    std::vector<std::vector<glm::vec3> > curves;
+    std::vector<glm::vec3> sceneColors;
+    JobSystem jobs(options.threads);
+    // From opening the scene file to the flattened arrays the GL objects are built from.
+    double sceneLoadMs = 0.0;
+    std::chrono::steady_clock::time_point sceneStart = std::chrono::steady_clock::now();
+    size_t sceneBytes = 0;
+    if (!options.scene.empty()) {
+        if (SceneArchive::isArchive(options.scene)) {
+            SceneArchive archive;
+            if (!archive.open(options.scene) || !archive.load(&jobs))
+                return 1;
+            sceneBytes = archive.fileBytes();
+            if (!readCurves(archive, options.scene, curves, sceneColors))
+                return 1;
+        } else {
+            SceneFile scene;
+            if (!scene.open(options.scene))
+                return 1;
+            sceneBytes = scene.fileBytes();
+            if (!readCurves(scene, options.scene, curves, sceneColors))
+                return 1;
+        }
+        options.curves = (int)curves.size();
+        options.points = (int)(sceneColors.size() / curves.size());
+    } else {
+        generateScene(options, random, curves);
+    }
+
+    // Flattened views for the GL objects: every control point, every segment.
+    std::vector<glm::vec3> allPoints, allColors;
+    std::vector<std::vector<CubicSegment> > curveSegments(curves.size());
+    std::vector<CubicSegment> allSegments;
+    std::vector<int> firstPoint(curves.size()), firstSegment(curves.size());
+    for (size_t c = 0; c < curves.size(); ++c) {
+        firstPoint[c] = (int)allPoints.size();
+        firstSegment[c] = (int)allSegments.size();
+        buildClosedCurve(curves[c], curveSegments[c]);
+        allSegments.insert(allSegments.end(), curveSegments[c].begin(), curveSegments[c].end());
+        for (size_t i = 0; i < curves[c].size(); ++i) {
+            allPoints.push_back(curves[c][i]);
+            if (sceneColors.empty())
+                allColors.push_back(glm::vec3(random.next(), random.next(), random.next()));
+            else
+                allColors.push_back(sceneColors[allPoints.size() - 1]);
+        }
+    }
+    if (!options.scene.empty())
+        sceneLoadMs = millisecondsSince(sceneStart);
+    if (!options.writeScene.empty() || !options.writeArchive.empty()) {
+        SceneWriter writer;
+        for (size_t c = 0; c < curves.size(); ++c)
+            writer.addCurve(curves[c], std::vector<glm::vec3>(allColors.begin() + firstPoint[c],
+                                                              allColors.begin() + firstPoint[c] + curves[c].size()), true);
+        if (!options.writeScene.empty() && !writer.write(options.writeScene))
+            return 1;
+        if (!options.writeArchive.empty() && !SceneArchive::write(options.writeArchive, writer))
+            return 1;
+    }
+
+    uint64_t setupBytes = UploadStats::total();
+    PointsObject points(allPoints, allColors, options.pointPositions, options.tileSize);
+    LineObject lines(glm::vec3(1.0f), 2.0f);
+    FrameArena frameArena;
+    lines.setScratchArena(&frameArena);
+    FillObject fill(glm::vec3(0.2f, 0.3f, 0.6f));
+    fill.setSegments(allSegments);
+    setupBytes = UploadStats::total() - setupBytes;
+
+    ParallelTessellator tessellator;
+    std::vector<glm::vec3> vertices;
+    std::vector<PolylineRun> runs;
+
+    // The parallel tessellator promises the serial output bit for bit; check
+    // that on this scene, with the default chunking and one curve per chunk.
+    {
+        std::vector<glm::vec3> serialVertices;
+        std::vector<PolylineRun> serialRuns;
+        tessellateCurves(curves, options.steps, true, serialVertices, serialRuns);
+        ParallelTessellator perCurve;
+        perCurve.setGrain(1);
+        ParallelTessellator* checks[] = { &tessellator, &perCurve };
+        for (ParallelTessellator* check : checks) {
+            check->tessellate(jobs, curves, options.steps, true, vertices, runs);
+            bool same = vertices.size() == serialVertices.size() && runs.size() == serialRuns.size() &&
+                        (vertices.empty() || memcmp(vertices.data(), serialVertices.data(),
+                                                    vertices.size() * sizeof(glm::vec3)) == 0);
+            for (size_t r = 0; same && r < runs.size(); ++r)
+                same = runs[r].first == serialRuns[r].first && runs[r].count == serialRuns[r].count &&
+                       runs[r].closed == serialRuns[r].closed;
+            if (!same) {
+                fprintf(stderr, "ParallelTessellator output differs from tessellateCurves()\n");
+                return 1;
+            }
+        }
+    }
+
+    enum Phase { Frame, Edit, Tessellate, Upload, Draw, Pick, Finish, PhaseCount };
+    PhaseTimes phases[PhaseCount] = {
+        { "frame", {} }, { "edit", {} }, { "tessellate", {} }, { "upload", {} },
+        { "draw", {} }, { "pick", {} }, { "finish", {} }
+    };
+    for (int p = 0; p < PhaseCount; ++p)
+        phases[p].samples.reserve(options.frames);
+
+    glm::vec2 viewCenter(0.0f);
+    float zoom = 1.0f;
+    int dragCurve = 0, dragPoint = 0;
+    glm::vec3 dragOrigin(0.0f);
+    int picks = 0, pickHits = 0, pickErrors = 0, pickOverlapped = 0;
+    uint64_t frameBytes = UploadStats::total();
+    AllocationCounter::Counts frameAllocations = AllocationCounter::allThreads();
+
+    typedef std::chrono::steady_clock Clock;
+    Clock::time_point benchStart = Clock::now();
+    for (int frame = 0; frame < options.frames; ++frame) {
+        Clock::time_point frameStart = Clock::now();
+        // The script cycles drag -> pick -> zoom, options.actionFrames frames each.
+        int action = (frame / options.actionFrames) % 3;
+        int actionFrame = frame % options.actionFrames;
+        float phaseAngle = 6.2831853f * (float)actionFrame / (float)options.actionFrames;
+
+        Clock::time_point start = Clock::now();
+        if (action == 0) {
+            if (actionFrame == 0) {
+                dragCurve = random.below((int)curves.size());
+                dragPoint = random.below((int)curves[dragCurve].size());
+                dragOrigin = curves[dragCurve][dragPoint];
+            }
+            float reach = 0.3f * kViewHalfHeight / std::sqrt((float)curves.size());
+            glm::vec3 position = dragOrigin + reach * glm::vec3(std::sin(phaseAngle), 1.0f - std::cos(phaseAngle), 0.0f);
+            curves[dragCurve][dragPoint] = position;
+            allPoints[firstPoint[dragCurve] + dragPoint] = position;
+            updateClosedCurve(curves[dragCurve], dragPoint, curveSegments[dragCurve]);
+        } else if (action == 2) {
+            if (actionFrame == 0)
+                viewCenter = glm::vec2(allPoints[random.below((int)allPoints.size())]);
+            zoom = 1.0f + 3.0f * (1.0f - std::cos(phaseAngle)); // 1x .. 7x and back
+        } else {
+            zoom = 1.0f;
+            viewCenter = glm::vec2(0.0f);
+        }
+        phases[Edit].samples.push_back(millisecondsSince(start));
+
+        // The whole scene every frame: the worst case, and independent of the script.
+        start = Clock::now();
+        int steps = glm::clamp((int)std::ceil(options.steps * std::sqrt(zoom)), 1, 64);
+        tessellator.tessellate(jobs, curves, steps, true, vertices, runs);
+        phases[Tessellate].samples.push_back(millisecondsSince(start));
+
+        start = Clock::now();
+        if (action == 0) {
+            points.updatePoint(firstPoint[dragCurve] + dragPoint, curves[dragCurve][dragPoint]);
+            int n = (int)curveSegments[dragCurve].size();
+            for (int k = -2; k <= 1; ++k) {
+                int i = ((dragPoint + k) % n + n) % n;
+                fill.updateSegment(firstSegment[dragCurve] + i, curveSegments[dragCurve][i]);
+            }
+        }
+        lines.upload(vertices, runs);
+        phases[Upload].samples.push_back(millisecondsSince(start));
+
+        glm::vec2 halfExtent = glm::vec2(kViewHalfWidth, kViewHalfHeight) / zoom;
+        glm::mat4 projection = glm::ortho(viewCenter.x - halfExtent.x, viewCenter.x + halfExtent.x,
+                                          viewCenter.y - halfExtent.y, viewCenter.y + halfExtent.y, 0.0f, 100.0f);
+        glm::mat4 view(1.0f);
+
+        if (action == 1) {
+            // Pick a random point where it is drawn, as a click on it would. Picking ids are one 8-bit channel
+            // that saturates, so only the first 254 points have their own; of those, only points no other
+            // sprite touches are fair targets, since whichever is drawn last owns the shared pixels.
+            glm::vec4 viewport(0, 0, options.width, options.height);
+            std::vector<glm::vec2> screen(allPoints.size());
+            for (size_t i = 0; i < allPoints.size(); ++i)
+                screen[i] = glm::vec2(glm::project(allPoints[i], view, projection, viewport));
+            std::vector<int> clear;
+            for (int i = 0; i < glm::min((int)allPoints.size(), kPickableIds); ++i) {
+                glm::vec2 pixel = glm::floor(screen[i]) + 0.5f;
+                bool overlapped = false;
+                for (size_t j = 0; j < allPoints.size() && !overlapped; ++j) {
+                    glm::vec2 offset = glm::abs(screen[j] - pixel);
+                    overlapped = (int)j != i && glm::max(offset.x, offset.y) <= kPointSize * 0.5f + 1.0f;
+                }
+                if (!overlapped)
+                    clear.push_back(i);
+            }
+            if (clear.empty()) {
+                pickOverlapped++;
+            } else {
+                int target = clear[random.below((int)clear.size())];
+                start = Clock::now();
+                glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+                points.drawPicking(view, projection);
+                unsigned char data[4] = { 0, 0, 0, 0 };
+                glReadPixels((int)screen[target].x, (int)screen[target].y, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, data);
+                phases[Pick].samples.push_back(millisecondsSince(start));
+                picks++;
+                if (data[0] == target + 1) {
+                    pickHits++;
+                } else {
+                    fprintf(stderr, "frame %d: pick of point %d at (%d, %d) read id %d\n", frame, target,
+                            (int)screen[target].x, (int)screen[target].y, data[0]);
+                    pickErrors++;
+                }
+            }
+        }
+
+        start = Clock::now();
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+        fill.draw(view, projection);
+        lines.draw(view, projection);
+        points.draw(view, projection);
+        phases[Draw].samples.push_back(millisecondsSince(start));
+
+        // Wait for the frame so GPU (or llvmpipe) time lands in the frame time.
+        start = Clock::now();
+        glFinish();
+        phases[Finish].samples.push_back(millisecondsSince(start));
+        frameArena.reset();
+        phases[Frame].samples.push_back(millisecondsSince(frameStart));
+    }
+    double seconds = millisecondsSince(benchStart) * 1e-3;
+    frameBytes = UploadStats::total() - frameBytes;
+    frameAllocations = AllocationCounter::allThreads() - frameAllocations;
+
+    GLenum error = glGetError();
+    if (error != GL_NO_ERROR)
+        fprintf(stderr, "GL error 0x%x during the run\n", error);
+
+    FILE* file = options.out == "-" ? jsonOut : fopen(options.out.c_str(), "w");
+    if (!file) {
+        fprintf(stderr, "Could not write %s\n", options.out.c_str());
+        return 1;
+    }
+    fprintf(file, "{\n");
+    fprintf(file, "  \"backend\": \"%s\",\n", context.backend());
+    fprintf(file, "  \"renderer\": \"%s\",\n", (const char*)glGetString(GL_RENDERER));
+    fprintf(file, "  \"scene\": { \"curves\": %d, \"points_per_curve\": %d, \"segments\": %zu, \"width\": %d, \"height\": %d, "
+                  "\"steps\": %d, \"threads\": %d, \"seed\": %u },\n",
+            options.curves, options.points, allSegments.size(), options.width, options.height, options.steps,
+            jobs.threadCount(), options.seed);
+    if (!options.scene.empty())
+        fprintf(file, "  \"scene_load_ms\": %.3f,\n  \"scene_bytes\": %zu,\n", sceneLoadMs, sceneBytes);
+    fprintf(file, "  \"frames\": %d,\n  \"seconds\": %.4f,\n  \"fps\": %.2f,\n", options.frames, seconds, options.frames / seconds);
+    fprintf(file, "  \"picks\": %d,\n  \"pick_hits\": %d,\n  \"pick_errors\": %d,\n  \"pick_overlapped\": %d,\n", picks,
+            pickHits, pickErrors, pickOverlapped);
+    fprintf(file, "  \"point_format\": \"%s\",\n  \"point_buffer_bytes\": %zu,\n",
+            pointFormatName(options.pointPositions), points.bufferBytes());
+    fprintf(file, "  \"bytes_uploaded_setup\": %llu,\n", (unsigned long long)setupBytes);
+    fprintf(file, "  \"bytes_uploaded\": %llu,\n  \"bytes_per_frame\": %.1f,\n",
+            (unsigned long long)frameBytes, (double)frameBytes / options.frames);
+    // Heap allocations during the frames, by every thread; null unless built with P2_COUNT_ALLOCATIONS.
+    if (AllocationCounter::compiledIn())
+        fprintf(file, "  \"allocations\": %llu,\n  \"allocated_bytes\": %llu,\n",
+                (unsigned long long)frameAllocations.allocations, (unsigned long long)frameAllocations.bytes);
+    else
+        fprintf(file, "  \"allocations\": null,\n  \"allocated_bytes\": null,\n");
+    fprintf(file, "  \"frame_arena_high_water\": %zu,\n", frameArena.highWater());
+    fprintf(file, "  \"cpu_ms\": {\n");
+    for (int p = 0; p < PhaseCount; ++p)
+        writePhase(file, phases[p], p + 1 == PhaseCount);
+    fprintf(file, "  }\n}\n");
+    fclose(file);
+    if (options.out != "-") {
+        printf("%d frames in %.2f s (%.1f fps) on %s, results in %s\n", options.frames, seconds,
+               options.frames / seconds, context.backend(), options.out.c_str());
+    }
+    if (pickErrors > 0)
+        fprintf(stderr, "%d of %d picks missed their point\n", pickErrors, picks);
+    // Picks skipped for lack of a clear target checked nothing; a run where none was clear did not test picking.
+    bool pickTested = pickHits > 0 || pickOverlapped == 0;
+    if (!pickTested)
+        fprintf(stderr, "no pick had a clear target (%d skipped); picking went untested\n", pickOverlapped);
+    return error == GL_NO_ERROR && pickErrors == 0 && pickTested ? 0 : 1;
+}
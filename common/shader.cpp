@@ -13,8 +13,10 @@ using namespace std;
 #include <GL/glew.h>
 
 #include "shader.hpp"
+#include "source/Trace.hpp"
 
 GLuint LoadShaders(const char * vertex_file_path,const char * fragment_file_path){
+	TRACE_SCOPE("LoadShaders");
 
 	// Create the shaders
 	GLuint VertexShaderID = glCreateShader(GL_VERTEX_SHADER);
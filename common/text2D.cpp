@@ -18,6 +18,12 @@ unsigned int Text2DUVBufferID;
 unsigned int Text2DShaderID;
 unsigned int Text2DUniformID;
 
+// Reused by every printText2D call so printing does not allocate once they
+// have grown to the longest string; the GL buffers grow the same way.
+std::vector<glm::vec2> Text2DVertices;
+std::vector<glm::vec2> Text2DUVs;
+size_t Text2DBufferCapacity = 0; // vertices
+
 void initText2D(const char * texturePath){
 
 	// Initialize texture
@@ -40,8 +46,10 @@ void printText2D(const char * text, int x, int y, int size){
 	unsigned int length = strlen(text);
 
 	// Fill buffers
-	std::vector<glm::vec2> vertices;
-	std::vector<glm::vec2> UVs;
+	std::vector<glm::vec2>& vertices = Text2DVertices;
+	std::vector<glm::vec2>& UVs = Text2DUVs;
+	vertices.clear();
+	UVs.clear();
 	for ( unsigned int i=0 ; i<length ; i++ ){
 		
 		glm::vec2 vertex_up_left    = glm::vec2( x+i*size     , y+size );
@@ -73,10 +81,19 @@ void printText2D(const char * text, int x, int y, int size){
 		UVs.push_back(uv_up_right);
 		UVs.push_back(uv_down_left);
 	}
+	if (vertices.empty())
+		return;
+	if (vertices.size() > Text2DBufferCapacity) {
+		Text2DBufferCapacity = vertices.size();
+		glBindBuffer(GL_ARRAY_BUFFER, Text2DVertexBufferID);
+		glBufferData(GL_ARRAY_BUFFER, Text2DBufferCapacity * sizeof(glm::vec2), NULL, GL_STREAM_DRAW);
+		glBindBuffer(GL_ARRAY_BUFFER, Text2DUVBufferID);
+		glBufferData(GL_ARRAY_BUFFER, Text2DBufferCapacity * sizeof(glm::vec2), NULL, GL_STREAM_DRAW);
+	}
 	glBindBuffer(GL_ARRAY_BUFFER, Text2DVertexBufferID);
-	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(glm::vec2), &vertices[0], GL_STATIC_DRAW);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, vertices.size() * sizeof(glm::vec2), &vertices[0]);
 	glBindBuffer(GL_ARRAY_BUFFER, Text2DUVBufferID);
-	glBufferData(GL_ARRAY_BUFFER, UVs.size() * sizeof(glm::vec2), &UVs[0], GL_STATIC_DRAW);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, UVs.size() * sizeof(glm::vec2), &UVs[0]);
 
 	// Bind shader
 	glUseProgram(Text2DShaderID);
@@ -115,6 +132,7 @@ void cleanupText2D(){
 	// Delete buffers
 	glDeleteBuffers(1, &Text2DVertexBufferID);
 	glDeleteBuffers(1, &Text2DUVBufferID);
+	Text2DBufferCapacity = 0;
 
 	// Delete texture
 	glDeleteTextures(1, &Text2DTextureID);
@@ -0,0 +1,112 @@
+#include "AllocationCounter.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+std::atomic<uint64_t> totalAllocations(0);
+std::atomic<uint64_t> totalBytes(0);
+thread_local AllocationCounter::Counts threadCounts = { 0, 0 };
+
+} // namespace
+
+namespace AllocationCounter {
+
+#ifdef P2_COUNT_ALLOCATIONS
+
+bool compiledIn() {
+    return true;
+}
+
+#else
+
+bool compiledIn() {
+    return false;
+}
+
+#endif
+
+Counts thisThread() {
+    return threadCounts;
+}
+
+Counts allThreads() {
+    Counts counts = { totalAllocations.load(std::memory_order_relaxed), totalBytes.load(std::memory_order_relaxed) };
+    return counts;
+}
+
+} // namespace AllocationCounter
+
+#ifdef P2_COUNT_ALLOCATIONS
+
+namespace {
+
+void count(size_t size) {
+    threadCounts.allocations++;
+    threadCounts.bytes += size;
+    totalAllocations.fetch_add(1, std::memory_order_relaxed);
+    totalBytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+// Both return null on failure; the throwing operators turn that into bad_alloc.
+void* allocate(size_t size) {
+    count(size);
+    return std::malloc(size ? size : 1);
+}
+
+void* allocateAligned(size_t size, std::align_val_t alignment) {
+    // posix_memalign wants at least the alignment of a pointer.
+    size_t align = (size_t)alignment < sizeof(void*) ? sizeof(void*) : (size_t)alignment;
+    count(size);
+#ifdef _MSC_VER
+    return _aligned_malloc(size ? size : 1, align);
+#else
+    void* p = nullptr;
+    return posix_memalign(&p, align, size ? size : 1) == 0 ? p : nullptr;
+#endif
+}
+
+void freeAligned(void* p) {
+#ifdef _MSC_VER
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+void* orThrow(void* p) {
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+} // namespace
+
+void* operator new(size_t size) { return orThrow(allocate(size)); }
+void* operator new[](size_t size) { return orThrow(allocate(size)); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+
+void* operator new(size_t size, std::align_val_t alignment) { return orThrow(allocateAligned(size, alignment)); }
+void* operator new[](size_t size, std::align_val_t alignment) { return orThrow(allocateAligned(size, alignment)); }
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return allocateAligned(size, alignment);
+}
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return allocateAligned(size, alignment);
+}
+void operator delete(void* p, std::align_val_t) noexcept { freeAligned(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { freeAligned(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { freeAligned(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { freeAligned(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { freeAligned(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { freeAligned(p); }
+
+#endif // P2_COUNT_ALLOCATIONS
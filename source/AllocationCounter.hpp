@@ -0,0 +1,33 @@
+#ifndef ALLOCATIONCOUNTER_HPP
+#define ALLOCATIONCOUNTER_HPP
+
+#include <cstdint>
+
+// Heap allocation counts for finding allocations in the frame loop. Builds
+// with P2_COUNT_ALLOCATIONS replace the global operator new and delete
+// (AllocationCounter.cpp) to count every C++ allocation, per thread and in
+// total; other builds leave the allocator alone and every count reads 0.
+// Only operator new is seen: malloc calls, e.g. inside the GL driver, are not.
+namespace AllocationCounter {
+
+struct Counts {
+    uint64_t allocations;
+    uint64_t bytes;
+};
+
+inline Counts operator-(Counts a, Counts b) {
+    Counts d = { a.allocations - b.allocations, a.bytes - b.bytes };
+    return d;
+}
+
+// Whether the counting operator new is built in.
+bool compiledIn();
+
+// Allocations made by the calling thread since it started.
+Counts thisThread();
+// Allocations made by every thread since the process started.
+Counts allThreads();
+
+} // namespace AllocationCounter
+
+#endif // ALLOCATIONCOUNTER_HPP
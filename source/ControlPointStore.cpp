@@ -0,0 +1,62 @@
+#include "ControlPointStore.hpp"
+#include <cstring>
+#include <new>
+
+namespace {
+
+const size_t kPageAlignment = 64;
+const size_t kPageBytes = ControlPointStore::StreamCount * ControlPointStore::kPageSize * sizeof(float);
+
+} // namespace
+
+ControlPointStore::ControlPointStore() : count(0) {
+}
+
+ControlPointStore::~ControlPointStore() {
+    clear();
+}
+
+void ControlPointStore::push(const glm::vec3& position, const glm::vec3& color, float weight) {
+    if (count == capacity()) {
+        float* page = static_cast<float*>(::operator new(kPageBytes, std::align_val_t(kPageAlignment)));
+        memset(page, 0, kPageBytes);
+        pages.push_back(page);
+    }
+    size_t index = count++;
+    setPosition(index, position);
+    setColor(index, color);
+    setWeight(index, weight);
+}
+
+void ControlPointStore::clear() {
+    for (size_t p = 0; p < pages.size(); ++p)
+        ::operator delete(pages[p], std::align_val_t(kPageAlignment));
+    pages.clear();
+    count = 0;
+}
+
+glm::vec3 ControlPointStore::position(size_t index) const {
+    return glm::vec3(get(index, X), get(index, Y), get(index, Z));
+}
+
+glm::vec3 ControlPointStore::color(size_t index) const {
+    return glm::vec3(get(index, R), get(index, G), get(index, B));
+}
+
+void ControlPointStore::setPosition(size_t index, const glm::vec3& position) {
+    set(index, X, position.x);
+    set(index, Y, position.y);
+    set(index, Z, position.z);
+}
+
+void ControlPointStore::setColor(size_t index, const glm::vec3& color) {
+    set(index, R, color.r);
+    set(index, G, color.g);
+    set(index, B, color.b);
+}
+
+size_t ControlPointStore::pagePoints(size_t page) const {
+    if (page + 1 < pages.size())
+        return kPageSize;
+    return count - page * kPageSize;
+}
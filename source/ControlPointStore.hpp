@@ -0,0 +1,59 @@
+#ifndef CONTROLPOINTSTORE_HPP
+#define CONTROLPOINTSTORE_HPP
+
+#include <cstddef>
+#include <vector>
+#include <glm/glm.hpp>
+
+// Control points as structure-of-arrays: separate x, y, z, weight and r, g, b
+// streams of floats. Storage comes in fixed pages of kPageSize points, each
+// stream of a page 64-byte aligned, so adding points never moves the ones
+// already stored and pointers into a page stay valid until clear().
+//
+// Bulk readers take the streams in place: stream(page, s) is a page's worth
+// of one stream. PointsObject packs its vertex uploads from them. Lanes past
+// the last point of the last page are zero.
+class ControlPointStore {
+public:
+    enum Stream { X, Y, Z, W, R, G, B, StreamCount };
+    static const size_t kPageSize = 256; // points; a multiple of 16 keeps every stream on a 64-byte boundary
+
+    ControlPointStore();
+    ~ControlPointStore();
+
+    ControlPointStore(const ControlPointStore&) = delete;
+    ControlPointStore& operator=(const ControlPointStore&) = delete;
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    // Points the allocated pages hold.
+    size_t capacity() const { return pages.size() * kPageSize; }
+
+    void push(const glm::vec3& position, const glm::vec3& color, float weight = 1.0f);
+    // Drops every point and frees the pages.
+    void clear();
+
+    glm::vec3 position(size_t index) const;
+    glm::vec3 color(size_t index) const;
+    float weight(size_t index) const { return get(index, W); }
+    void setPosition(size_t index, const glm::vec3& position);
+    void setColor(size_t index, const glm::vec3& color);
+    void setWeight(size_t index, float weight) { set(index, W, weight); }
+
+    // Pages hold kPageSize points except the last, which holds pagePoints(page).
+    size_t pagePoints(size_t page) const;
+    const float* stream(size_t page, Stream s) const { return pages[page] + s * kPageSize; }
+
+    // The page holding a point and its lane in there.
+    static size_t pageOf(size_t index) { return index / kPageSize; }
+    static size_t laneOf(size_t index) { return index % kPageSize; }
+
+private:
+    float get(size_t index, Stream s) const { return pages[pageOf(index)][s * kPageSize + laneOf(index)]; }
+    void set(size_t index, Stream s, float v) { pages[pageOf(index)][s * kPageSize + laneOf(index)] = v; }
+
+    std::vector<float*> pages; // StreamCount * kPageSize floats each, stream after stream
+    size_t count;
+};
+
+#endif // CONTROLPOINTSTORE_HPP
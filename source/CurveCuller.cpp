@@ -0,0 +1,106 @@
+#include "CurveCuller.hpp"
+#include <cmath>
+#include "FrameArena.hpp"
+#include "PolySolver.hpp"
+
+CurveCuller::CurveCuller() : tolerance(0.25f), maxSteps(64) {
+}
+
+void CurveCuller::setTolerance(float pixels) {
+    tolerance = pixels;
+}
+
+void CurveCuller::setMaxSteps(int steps) {
+    maxSteps = steps;
+}
+
+void CurveCuller::rebuild(const std::vector<CubicSegment>& segments, FrameArena* arena) {
+    size_t n = segments.size();
+    resize(n);
+    if (n > 0)
+        computeBounds(segments.data(), nullptr, n, 0, arena);
+}
+
+void CurveCuller::update(int index, const CubicSegment& segment, FrameArena* arena) {
+    if (index < 0 || index >= (int)minX.size())
+        return;
+    computeBounds(&segment, nullptr, 1, index, arena);
+}
+
+void CurveCuller::resize(size_t count) {
+    minX.resize(count);
+    minY.resize(count);
+    maxX.resize(count);
+    maxY.resize(count);
+    curvature.resize(count);
+}
+
+void CurveCuller::refit(const std::vector<CubicSegment>& segments, const int* indices, size_t count, FrameArena* arena) {
+    if (count > 0)
+        computeBounds(segments.data(), indices, count, 0, arena);
+}
+
+// Extremes of a cubic per axis are at its end points or where the derivative,
+// the quadratic (A - 2B + C) t^2 + 2 (B - A) t + A with A, B, C the control
+// point differences, vanishes. All 2 * count quadratics go through one batch solve.
+void CurveCuller::computeBounds(const CubicSegment* segments, const int* indices, size_t count, size_t firstIndex, FrameArena* arena) {
+    size_t equations = 2 * count;
+    ArenaAllocator<float> floats(arena);
+    ArenaVector<float> qa(equations, floats), qb(equations, floats), qc(equations, floats);
+    ArenaVector<float> roots(2 * equations, floats);
+    ArenaVector<uint8_t> rootCounts(equations, ArenaAllocator<uint8_t>(arena));
+
+    for (size_t i = 0; i < count; ++i) {
+        const CubicSegment& s = segments[indices ? indices[i] : i];
+        for (int axis = 0; axis < 2; ++axis) {
+            float A = s.p[1][axis] - s.p[0][axis];
+            float B = s.p[2][axis] - s.p[1][axis];
+            float C = s.p[3][axis] - s.p[2][axis];
+            size_t e = axis * count + i;
+            qa[e] = A - 2.0f * B + C;
+            qb[e] = 2.0f * (B - A);
+            qc[e] = A;
+        }
+    }
+    solveQuadratics(qa.data(), qb.data(), qc.data(), equations, roots.data(), rootCounts.data(), nullptr);
+
+    for (size_t i = 0; i < count; ++i) {
+        const CubicSegment& s = segments[indices ? indices[i] : i];
+        glm::vec2 lo = glm::min(glm::vec2(s.p[0]), glm::vec2(s.p[3]));
+        glm::vec2 hi = glm::max(glm::vec2(s.p[0]), glm::vec2(s.p[3]));
+        for (int axis = 0; axis < 2; ++axis) {
+            size_t e = axis * count + i;
+            for (int r = 0; r < rootCounts[e]; ++r) {
+                float t = roots[r * equations + e];
+                if (t > 0.0f && t < 1.0f) {
+                    float v = evaluateSegment(s, t)[axis];
+                    lo[axis] = glm::min(lo[axis], v);
+                    hi[axis] = glm::max(hi[axis], v);
+                }
+            }
+        }
+        size_t k = indices ? (size_t)indices[i] : firstIndex + i;
+        minX[k] = lo.x;
+        minY[k] = lo.y;
+        maxX[k] = hi.x;
+        maxY[k] = hi.y;
+        curvature[k] = glm::max(glm::length(glm::vec2(s.p[0] - 2.0f * s.p[1] + s.p[2])),
+                                glm::length(glm::vec2(s.p[1] - 2.0f * s.p[2] + s.p[3])));
+    }
+}
+
+void CurveCuller::cull(const glm::vec2& viewMin, const glm::vec2& viewMax, float pixelsPerUnit, std::vector<SegmentDraw>& out) const {
+    out.clear();
+    for (size_t i = 0; i < minX.size(); ++i) {
+        if (maxX[i] < viewMin.x || minX[i] > viewMax.x || maxY[i] < viewMin.y || minY[i] > viewMax.y)
+            continue;
+        // A cubic's second derivative is bounded by 6 * curvature; sampling with
+        // n steps deviates by at most that / (8 n^2) from the curve.
+        float bend = curvature[i] * pixelsPerUnit;
+        int steps = (int)std::ceil(std::sqrt(0.75f * bend / tolerance));
+        SegmentDraw item;
+        item.segment = (int)i;
+        item.steps = glm::clamp(steps, 1, maxSteps);
+        out.push_back(item);
+    }
+}
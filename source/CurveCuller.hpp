@@ -0,0 +1,58 @@
+#ifndef CURVECULLER_HPP
+#define CURVECULLER_HPP
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include "Tessellator.hpp"
+
+class FrameArena;
+
+// Per-frame visibility and level-of-detail for curve segments. Tight
+// axis-aligned bounds (end points plus derivative roots) and a curvature bound
+// are cached per segment and refreshed only for edited segments; cull() then
+// tests the cached bounds against the view rectangle and picks a step count
+// from the segment's projected size.
+class CurveCuller {
+public:
+    CurveCuller();
+
+    // Allowed distance between the curve and its polyline, in pixels.
+    void setTolerance(float pixels);
+    void setMaxSteps(int steps);
+
+    // rebuild(), update() and refit() take their root-solve scratch from the
+    // arena when one is given, otherwise from the heap.
+
+    // Recompute the cache for every segment.
+    void rebuild(const std::vector<CubicSegment>& segments, FrameArena* arena = nullptr);
+    // Recompute the cache for one segment.
+    void update(int index, const CubicSegment& segment, FrameArena* arena = nullptr);
+
+    // Refit in parallel: resize() once, then refit() disjoint sets of segment
+    // indices concurrently; the arena hands each thread its own memory.
+    void resize(size_t count);
+    void refit(const std::vector<CubicSegment>& segments, const int* indices, size_t count, FrameArena* arena = nullptr);
+
+    // Writes the visible segments in ascending order to out (cleared first),
+    // each with the step count needed at pixelsPerUnit.
+    void cull(const glm::vec2& viewMin, const glm::vec2& viewMax, float pixelsPerUnit, std::vector<SegmentDraw>& out) const;
+
+    size_t size() const { return minX.size(); }
+    glm::vec2 boundsMin(int index) const { return glm::vec2(minX[index], minY[index]); }
+    glm::vec2 boundsMax(int index) const { return glm::vec2(maxX[index], maxY[index]); }
+
+private:
+    // Bounds of segments[indices[i]] (or segments[i] without indices), stored
+    // at indices[i] (or firstIndex + i).
+    void computeBounds(const CubicSegment* segments, const int* indices, size_t count, size_t firstIndex, FrameArena* arena);
+
+    float tolerance;
+    int maxSteps;
+
+    // Cache, structure-of-arrays.
+    std::vector<float> minX, minY, maxX, maxY;
+    std::vector<float> curvature; // max |second difference| of the control points
+};
+
+#endif // CURVECULLER_HPP
@@ -0,0 +1,188 @@
+#include "CurveWorker.hpp"
+#include <algorithm>
+#include <GLFW/glfw3.h>
+#include "Trace.hpp"
+
+CurveWorker::CurveWorker()
+    : wakeRequested(false), stopRequested(false), jobThreads(-1), refitTask(-1),
+      hasInput(false), gotInput(false), refined(false), dirty(false) {
+    stroker.setJoin(JoinStyle::Round);
+    stroker.setCap(CapStyle::Round);
+    stroker.setArena(&arena);
+}
+
+CurveWorker::~CurveWorker() {
+    stop();
+}
+
+void CurveWorker::setRefineBudget(double milliseconds) {
+    refiner.setBudget(milliseconds);
+}
+
+void CurveWorker::setJobThreads(int workers) {
+    jobThreads = workers;
+}
+
+void CurveWorker::start() {
+    if (thread.joinable())
+        return;
+    if (!jobs) {
+        jobs.reset(new JobSystem(jobThreads));
+        buildFrameGraph();
+    }
+    stopRequested = false;
+    thread = std::thread(&CurveWorker::run, this);
+}
+
+void CurveWorker::stop() {
+    if (!thread.joinable())
+        return;
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        stopRequested = true;
+    }
+    wakeCondition.notify_one();
+    thread.join();
+}
+
+void CurveWorker::submit(const CurveInput& input) {
+    CurveInput& slot = inputs.writeSlot();
+    slot.points.assign(input.points.begin(), input.points.end());
+    slot.viewMin = input.viewMin;
+    slot.viewMax = input.viewMax;
+    slot.worldPerPixel = input.worldPerPixel;
+    slot.strokeWidthPixels = input.strokeWidthPixels;
+    slot.gpuLines = input.gpuLines;
+    slot.sequence = input.sequence;
+    inputs.publish();
+    {
+        // Held only to set the flag, so a sleeping worker cannot miss the wake-up.
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        wakeRequested = true;
+    }
+    wakeCondition.notify_one();
+}
+
+void CurveWorker::run() {
+    TRACE_THREAD_NAME("curve worker");
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(wakeMutex);
+            // Keep going without sleeping while refinement is unfinished.
+            bool busy = hasInput && refiner.pendingSegments() > 0;
+            if (!busy)
+                wakeCondition.wait(lock, [this] { return wakeRequested || stopRequested; });
+            if (stopRequested)
+                return;
+            wakeRequested = false;
+        }
+        frameGraph.run(*jobs);
+    }
+}
+
+void CurveWorker::buildFrameGraph() {
+    TaskGraph::TaskId input = frameGraph.addTask("input", [this] {
+        passStart = std::chrono::steady_clock::now();
+        arena.reset(); // the last pass is over: nothing holds arena memory now
+        gotInput = inputs.acquire();
+    });
+    TaskGraph::TaskId edit = frameGraph.addTask("edit", [this] {
+        refitList.clear();
+        if (gotInput)
+            applyInput(inputs.readSlot());
+        frameGraph.setCount(refitTask, refitList.size());
+    });
+    refitTask = frameGraph.addParallelTask("refit", 64, [this](size_t begin, size_t end) {
+        culler.refit(segments, &refitList[begin], end - begin, &arena);
+    });
+    TaskGraph::TaskId cull = frameGraph.addTask("cull", [this] {
+        if (hasInput)
+            culler.cull(current.viewMin, current.viewMax, 1.0f / current.worldPerPixel, drawList);
+    });
+    TaskGraph::TaskId tessellate = frameGraph.addTask("tessellate", [this] {
+        refined = hasInput && refiner.update(segments, drawList, jobs.get(), &arena);
+    });
+    TaskGraph::TaskId prep = frameGraph.addTask("prep", [this] {
+        if (hasInput)
+            publishFrame();
+    });
+    frameGraph.precede(input, edit);
+    frameGraph.precede(edit, refitTask);
+    frameGraph.precede(refitTask, cull);
+    frameGraph.precede(cull, tessellate);
+    frameGraph.precede(tessellate, prep);
+}
+
+// Stale bounds are refit by the graph; the samples are dropped right away.
+void CurveWorker::markEdited(int segment) {
+    refitList.push_back(segment);
+    refiner.invalidate(segment);
+    revisions[segment]++;
+}
+
+void CurveWorker::applyInput(const CurveInput& input) {
+    size_t n = input.points.size();
+    if (!hasInput || n != current.points.size()) {
+        current.points = input.points;
+        buildClosedCurve(current.points, segments);
+        culler.resize(n);
+        refiner.reset(n);
+        revisions.resize(n);
+        for (size_t i = 0; i < n; ++i)
+            markEdited((int)i);
+    } else {
+        // Several edits may have been merged into one input: update every moved point.
+        for (int p = 0; p < (int)n; ++p) {
+            if (input.points[p] == current.points[p])
+                continue;
+            current.points[p] = input.points[p];
+            updateClosedCurve(current.points, p, segments);
+            for (int k = -2; k <= 1; ++k)
+                markEdited(((p + k) % (int)n + (int)n) % (int)n);
+        }
+        // Neighbouring moved points share segments; refit each only once.
+        std::sort(refitList.begin(), refitList.end());
+        refitList.erase(std::unique(refitList.begin(), refitList.end()), refitList.end());
+    }
+    current.viewMin = input.viewMin;
+    current.viewMax = input.viewMax;
+    current.worldPerPixel = input.worldPerPixel;
+    current.strokeWidthPixels = input.strokeWidthPixels;
+    current.gpuLines = input.gpuLines;
+    current.sequence = input.sequence;
+    hasInput = true;
+    dirty = true;
+}
+
+// Publishes a frame, but only when the drawn samples changed.
+void CurveWorker::publishFrame() {
+    if (!dirty && !refined && drawList == lastDrawList)
+        return;
+    lastDrawList = drawList;
+    dirty = false;
+
+    CurveFrame& frame = frames.writeSlot();
+    frame.segments.assign(segments.begin(), segments.end());
+    frame.segmentRevisions.assign(revisions.begin(), revisions.end());
+    frame.gpuLines = current.gpuLines;
+    frame.inputSequence = current.sequence;
+    frame.arenaHighWater = arena.highWater();
+    frame.pendingSegments = refiner.pendingSegments();
+    frame.pendingSamples = refiner.pendingSamples();
+    refiner.assemble(drawList, true, frame.polyline, frame.runs);
+    frame.strokeVertices.clear();
+    frame.strokeEdges.clear();
+    if (!current.gpuLines) {
+        // One extra pixel of width holds the anti-aliased rim.
+        stroker.setWidth((current.strokeWidthPixels + 1.0f) * current.worldPerPixel);
+        stroker.setTolerance(0.25f * current.worldPerPixel);
+        stroker.clear();
+        for (size_t r = 0; r < frame.runs.size(); ++r)
+            stroker.append(&frame.polyline[frame.runs[r].first], frame.runs[r].count, frame.runs[r].closed);
+        frame.strokeVertices.assign(stroker.vertices().begin(), stroker.vertices().end());
+        frame.strokeEdges.assign(stroker.edgeCoordinates().begin(), stroker.edgeCoordinates().end());
+    }
+    frame.passMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - passStart).count();
+    frames.publish();
+    glfwPostEmptyEvent();
+}
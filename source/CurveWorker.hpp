@@ -0,0 +1,112 @@
+#ifndef CURVEWORKER_HPP
+#define CURVEWORKER_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <glm/glm.hpp>
+#include "CurveCuller.hpp"
+#include "FrameArena.hpp"
+#include "JobSystem.hpp"
+#include "RefinementScheduler.hpp"
+#include "Stroker.hpp"
+#include "Tessellator.hpp"
+#include "TripleBuffer.hpp"
+
+// What the render thread wants drawn: the control points and the view.
+struct CurveInput {
+    std::vector<glm::vec3> points;
+    glm::vec2 viewMin, viewMax; // visible rectangle, already grown by the stroke
+    float worldPerPixel;
+    float strokeWidthPixels;
+    bool gpuLines; // polyline for LineObject, otherwise a CPU stroke for StrokeObject
+    uint64_t sequence = 0; // set by the caller, increasing; echoed in the frames built from it
+};
+
+// One tessellated frame. segmentRevisions[i] changes whenever segments[i]
+// does, so the render thread can re-upload only the edited fill hulls.
+struct CurveFrame {
+    std::vector<CubicSegment> segments;
+    std::vector<uint32_t> segmentRevisions;
+    bool gpuLines = true;
+    std::vector<glm::vec3> polyline;
+    std::vector<PolylineRun> runs;
+    std::vector<glm::vec3> strokeVertices;
+    std::vector<float> strokeEdges;
+    size_t pendingSegments = 0;
+    size_t pendingSamples = 0;
+    double passMilliseconds = 0.0; // worker time for the pass that produced this frame
+    uint64_t inputSequence = 0; // sequence of the newest input this frame reflects
+    size_t arenaHighWater = 0; // most pass-arena bytes any finished pass used
+};
+
+// Owns the curve and rebuilds, culls, refines and strokes it on its own
+// thread. The render thread submits inputs and picks up finished frames
+// through triple buffers, so neither side blocks on the other; only when it
+// has nothing to do does the worker sleep until the next submit. Each
+// published frame posts an empty GLFW event to wake a waiting render loop.
+// A pass is a task graph, input -> edit -> refit -> cull -> tessellate ->
+// prep, run on a job system; refit and tessellate split across segments.
+// Their scratch comes from a frame arena that the input task resets.
+class CurveWorker {
+public:
+    CurveWorker();
+    ~CurveWorker();
+
+    void setRefineBudget(double milliseconds);
+    // Pool size for start(); < 0 uses every hardware thread.
+    void setJobThreads(int workers);
+
+    void start();
+    void stop();
+
+    // Render thread. submit() copies the input; only the latest one is used.
+    void submit(const CurveInput& input);
+    bool frameReady() const { return frames.hasFresh(); }
+    // Switches to the newest finished frame; false when there is none.
+    bool acquireFrame() { return frames.acquire(); }
+    const CurveFrame& frame() const { return frames.readSlot(); }
+
+private:
+    void run();
+    void buildFrameGraph();
+    void applyInput(const CurveInput& input);
+    void markEdited(int segment);
+    void publishFrame();
+
+    TripleBuffer<CurveInput> inputs;
+    TripleBuffer<CurveFrame> frames;
+
+    std::thread thread;
+    std::mutex wakeMutex;
+    std::condition_variable wakeCondition;
+    bool wakeRequested;
+    bool stopRequested;
+
+    int jobThreads;
+    std::unique_ptr<JobSystem> jobs;
+    TaskGraph frameGraph;
+    TaskGraph::TaskId refitTask;
+
+    // Worker thread state.
+    CurveInput current;
+    bool hasInput;
+    bool gotInput; // this pass took a new input
+    bool refined;  // this pass changed a segment's samples
+    std::chrono::steady_clock::time_point passStart;
+    bool dirty;
+    std::vector<CubicSegment> segments;
+    std::vector<uint32_t> revisions;
+    std::vector<int> refitList; // segments whose bounds are stale
+    FrameArena arena;           // scratch for one pass
+    CurveCuller culler;
+    RefinementScheduler refiner;
+    Stroker stroker;
+    std::vector<SegmentDraw> drawList, lastDrawList;
+};
+
+#endif // CURVEWORKER_HPP
@@ -0,0 +1,177 @@
+#include "FillObject.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <glm/gtc/type_ptr.hpp>
+#include "common/shader.hpp"
+#include "UploadStats.hpp"
+
+namespace {
+
+// k = -1, l = m = 0 makes k^3 - l*m negative everywhere: always inside.
+const glm::vec3 kSolidKlm(-1.0f, 0.0f, 0.0f);
+
+void setupLayout(GLuint buffer) {
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(CurveFillVertex), (void*)offsetof(CurveFillVertex, position));
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(CurveFillVertex), (void*)offsetof(CurveFillVertex, klm));
+    glEnableVertexAttribArray(1);
+}
+
+} // namespace
+
+FillObject::FillObject(const glm::vec3& initColor)
+    : color(initColor), fillRule(FillRule::NonZero), anchor(0.0f), coverDirty(true) {
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &VBO_vertices);
+    glGenVertexArrays(1, &coverVAO);
+    glGenBuffers(1, &VBO_cover);
+
+    shaderProgram = LoadShaders("curveFillVertexShader.glsl", "curveFillFragmentShader.glsl");
+
+    glBindVertexArray(VAO);
+    setupLayout(VBO_vertices);
+    glBindVertexArray(coverVAO);
+    setupLayout(VBO_cover);
+    glBufferData(GL_ARRAY_BUFFER, 4 * sizeof(CurveFillVertex), NULL, GL_DYNAMIC_DRAW);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+FillObject::~FillObject() {
+    glDeleteVertexArrays(1, &VAO);
+    glDeleteBuffers(1, &VBO_vertices);
+    glDeleteVertexArrays(1, &coverVAO);
+    glDeleteBuffers(1, &VBO_cover);
+    glDeleteProgram(shaderProgram);
+}
+
+void FillObject::buildSegment(const CubicSegment& segment, std::vector<CurveFillVertex>& out) const {
+    CurveFillVertex v;
+    v.klm = kSolidKlm;
+    v.position = anchor;
+    out.push_back(v);
+    v.position = segment.p[0];
+    out.push_back(v);
+    v.position = segment.p[3];
+    out.push_back(v);
+    appendCubicHull(segment, out);
+}
+
+void FillObject::setSegments(const std::vector<CubicSegment>& segments) {
+    segmentCopy = segments;
+    // Any fixed point works as the fan centre; it must just stay put across edits.
+    anchor = segments.empty() ? glm::vec3(0.0f) : segments[0].p[0];
+
+    vertices.clear();
+    for (size_t i = 0; i < segments.size(); ++i)
+        buildSegment(segments[i], vertices);
+
+    glBindBuffer(GL_ARRAY_BUFFER, VBO_vertices);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(CurveFillVertex), vertices.data(), GL_DYNAMIC_DRAW);
+    UploadStats::add(vertices.size() * sizeof(CurveFillVertex));
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    coverDirty = true;
+}
+
+void FillObject::updateSegment(int index, const CubicSegment& segment) {
+    if (index < 0 || index >= (int)segmentCopy.size())
+        return;
+    segmentCopy[index] = segment;
+
+    scratch.clear();
+    buildSegment(segment, scratch);
+    size_t first = (size_t)index * kVerticesPerSegment;
+    std::copy(scratch.begin(), scratch.end(), vertices.begin() + first);
+
+    glBindBuffer(GL_ARRAY_BUFFER, VBO_vertices);
+    glBufferSubData(GL_ARRAY_BUFFER, first * sizeof(CurveFillVertex), kVerticesPerSegment * sizeof(CurveFillVertex), &vertices[first]);
+    UploadStats::add(kVerticesPerSegment * sizeof(CurveFillVertex));
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    coverDirty = true;
+}
+
+// Cover quad over the control-point bounds, which contain the curve.
+void FillObject::updateCover() {
+    glm::vec3 lo = anchor, hi = anchor;
+    for (size_t i = 0; i < segmentCopy.size(); ++i) {
+        for (int k = 0; k < 4; ++k) {
+            lo = glm::min(lo, segmentCopy[i].p[k]);
+            hi = glm::max(hi, segmentCopy[i].p[k]);
+        }
+    }
+    CurveFillVertex quad[4];
+    quad[0].position = glm::vec3(lo.x, lo.y, 0.0f);
+    quad[1].position = glm::vec3(hi.x, lo.y, 0.0f);
+    quad[2].position = glm::vec3(lo.x, hi.y, 0.0f);
+    quad[3].position = glm::vec3(hi.x, hi.y, 0.0f);
+    for (int k = 0; k < 4; ++k)
+        quad[k].klm = kSolidKlm;
+
+    glBindBuffer(GL_ARRAY_BUFFER, VBO_cover);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(quad), quad);
+    UploadStats::add(sizeof(quad));
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    coverDirty = false;
+}
+
+void FillObject::draw(const glm::mat4& view, const glm::mat4& projection) {
+    if (vertices.empty())
+        return;
+    if (coverDirty)
+        updateCover();
+
+    glUseProgram(shaderProgram);
+    glm::mat4 MVP = projection * view;
+    glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "MVP"), 1, GL_FALSE, glm::value_ptr(MVP));
+    glUniform3fv(glGetUniformLocation(shaderProgram, "fillColor"), 1, glm::value_ptr(color));
+    glUniform1i(glGetUniformLocation(shaderProgram, "stencilPass"), 1);
+
+    // Stencil: count coverage of fan and hull triangles; both windings matter.
+    glDisable(GL_CULL_FACE);
+    glEnable(GL_STENCIL_TEST);
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    glDepthMask(GL_FALSE);
+    glStencilMask(0xFF);
+    glStencilFunc(GL_ALWAYS, 0, 0xFF);
+    if (fillRule == FillRule::EvenOdd) {
+        glStencilOp(GL_KEEP, GL_KEEP, GL_INVERT);
+    } else {
+        glStencilOpSeparate(GL_FRONT, GL_KEEP, GL_KEEP, GL_INCR_WRAP);
+        glStencilOpSeparate(GL_BACK, GL_KEEP, GL_KEEP, GL_DECR_WRAP);
+    }
+    glBindVertexArray(VAO);
+    glDrawArrays(GL_TRIANGLES, 0, (GLsizei)vertices.size());
+
+    // Edge: the hull triangles again, blended, on the pixels left outside
+    // (count zero), so those the curve partly covers get that fraction.
+    // Fan triangles have no curve and discard.
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+    glStencilFunc(GL_EQUAL, 0, 0xFF);
+    glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
+    glUniform1i(glGetUniformLocation(shaderProgram, "stencilPass"), 0);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glDrawArrays(GL_TRIANGLES, 0, (GLsizei)vertices.size());
+    glUniform1i(glGetUniformLocation(shaderProgram, "stencilPass"), 1);
+
+    // Cover: color wherever the count is non-zero and reset the stencil as we go.
+    glDepthMask(GL_TRUE);
+    glStencilFunc(GL_NOTEQUAL, 0, 0xFF);
+    glStencilOp(GL_ZERO, GL_ZERO, GL_ZERO);
+    glBindVertexArray(coverVAO);
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+
+    glBindVertexArray(0);
+    glDisable(GL_STENCIL_TEST);
+    glEnable(GL_CULL_FACE);
+    glUseProgram(0);
+}
+
+void FillObject::setColor(const glm::vec3& newColor) {
+    color = newColor;
+}
+
+void FillObject::setFillRule(FillRule rule) {
+    fillRule = rule;
+}
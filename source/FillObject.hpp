@@ -0,0 +1,62 @@
+#ifndef FILLOBJECT_HPP
+#define FILLOBJECT_HPP
+
+#include <vector>
+#include <glm/glm.hpp>
+#include <GL/glew.h>
+#include "LoopBlinn.hpp"
+#include "Tessellator.hpp"
+
+enum class FillRule { EvenOdd, NonZero };
+
+// Fills a closed set of cubic segments with stencil-then-cover, so there is no
+// CPU triangulation. Each segment contributes a fan triangle (fixed anchor,
+// start, end) plus its Loop-Blinn hull triangles, all counted into the stencil
+// buffer. The hull triangles are then drawn again, blended, over the pixels
+// left at zero, giving the ones a curve partly covers their fraction; one
+// bounding quad then colors every pixel with a non-zero count and clears it
+// again. Segments own fixed slices of the vertex buffer, so editing
+// one only re-uploads that slice.
+class FillObject {
+public:
+    FillObject(const glm::vec3& color);
+    ~FillObject();
+
+    // Replace every segment (the anchor is re-chosen from the first segment).
+    void setSegments(const std::vector<CubicSegment>& segments);
+
+    // Rebuild and re-upload a single segment.
+    void updateSegment(int index, const CubicSegment& segment);
+
+    void draw(const glm::mat4& view, const glm::mat4& projection);
+
+    void setColor(const glm::vec3& newColor);
+    void setFillRule(FillRule rule);
+    FillRule getFillRule() const { return fillRule; }
+
+private:
+    static const int kVerticesPerSegment = 3 + kHullVerticesPerSegment;
+
+    void buildSegment(const CubicSegment& segment, std::vector<CurveFillVertex>& out) const;
+    void updateCover();
+
+    glm::vec3 color;
+    FillRule fillRule;
+    glm::vec3 anchor;
+
+    // CPU copies: per-segment control points for the cover bounds, vertices for uploads.
+    std::vector<CubicSegment> segmentCopy;
+    std::vector<CurveFillVertex> vertices;
+    std::vector<CurveFillVertex> scratch;
+    bool coverDirty;
+
+    // OpenGL objects.
+    GLuint VAO;
+    GLuint VBO_vertices;
+    GLuint coverVAO;
+    GLuint VBO_cover;
+
+    GLuint shaderProgram;
+};
+
+#endif // FILLOBJECT_HPP
@@ -0,0 +1,111 @@
+#include "FrameArena.hpp"
+#include <algorithm>
+#include <atomic>
+
+namespace {
+
+const size_t kBlockAlignment = 64;
+
+size_t roundUp(size_t bytes, size_t multiple) {
+    return (bytes + multiple - 1) / multiple * multiple;
+}
+
+char* allocateBlock(size_t bytes) {
+    return static_cast<char*>(::operator new(bytes, std::align_val_t(kBlockAlignment)));
+}
+
+void freeBlock(char* block) {
+    ::operator delete(block, std::align_val_t(kBlockAlignment));
+}
+
+} // namespace
+
+FrameArena::FrameArena(size_t initialBytesPerThread)
+    : initialBytes(roundUp(std::max(initialBytesPerThread, kBlockAlignment), kBlockAlignment)),
+      highWaterTotal(0), highWaterThread(0) {
+    for (int i = 0; i < kMaxThreads; ++i) {
+        subArenas[i].block = nullptr;
+        subArenas[i].capacity = 0;
+        subArenas[i].offset = 0;
+        subArenas[i].overflowBytes = 0;
+    }
+}
+
+FrameArena::~FrameArena() {
+    for (int i = 0; i < kMaxThreads; ++i) {
+        SubArena& arena = subArenas[i];
+        for (size_t b = 0; b < arena.overflow.size(); ++b)
+            freeBlock(arena.overflow[b]);
+        if (arena.block)
+            freeBlock(arena.block);
+    }
+}
+
+int FrameArena::threadSlot() {
+    static std::atomic<int> nextSlot(0);
+    thread_local int slot = std::min(nextSlot.fetch_add(1, std::memory_order_relaxed), kMaxThreads - 1);
+    return slot;
+}
+
+// Blocks are 64-byte aligned, so aligning the offset aligns the address.
+void* FrameArena::allocateFrom(SubArena& arena, size_t bytes, size_t alignment) {
+    if (!arena.block) {
+        arena.capacity = initialBytes;
+        arena.block = allocateBlock(arena.capacity);
+    }
+    size_t start = roundUp(arena.offset, alignment);
+    if (start + bytes <= arena.capacity) {
+        arena.offset = start + bytes;
+        return arena.block + start;
+    }
+    char* block = allocateBlock(std::max(bytes, (size_t)1));
+    arena.overflow.push_back(block);
+    arena.overflowBytes += bytes;
+    return block;
+}
+
+void* FrameArena::allocate(size_t bytes, size_t alignment) {
+    int slot = threadSlot();
+    SubArena& arena = subArenas[slot];
+    if (slot == kMaxThreads - 1) {
+        std::lock_guard<std::mutex> lock(sharedMutex);
+        return allocateFrom(arena, bytes, alignment);
+    }
+    return allocateFrom(arena, bytes, alignment);
+}
+
+void FrameArena::reset() {
+    size_t total = 0;
+    for (int i = 0; i < kMaxThreads; ++i) {
+        SubArena& arena = subArenas[i];
+        size_t peak = arena.offset + arena.overflowBytes;
+        total += peak;
+        highWaterThread = std::max(highWaterThread, peak);
+        if (!arena.overflow.empty()) {
+            // Room for this frame's peak plus alignment padding, in one block.
+            for (size_t b = 0; b < arena.overflow.size(); ++b)
+                freeBlock(arena.overflow[b]);
+            arena.overflow.clear();
+            freeBlock(arena.block);
+            arena.capacity = roundUp(peak + peak / 8, 4096);
+            arena.block = allocateBlock(arena.capacity);
+        }
+        arena.offset = 0;
+        arena.overflowBytes = 0;
+    }
+    highWaterTotal = std::max(highWaterTotal, total);
+}
+
+size_t FrameArena::used() const {
+    size_t total = 0;
+    for (int i = 0; i < kMaxThreads; ++i)
+        total += subArenas[i].offset + subArenas[i].overflowBytes;
+    return total;
+}
+
+size_t FrameArena::reserved() const {
+    size_t total = 0;
+    for (int i = 0; i < kMaxThreads; ++i)
+        total += subArenas[i].capacity;
+    return total;
+}
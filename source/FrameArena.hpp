@@ -0,0 +1,98 @@
+#ifndef FRAMEARENA_HPP
+#define FRAMEARENA_HPP
+
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+// Bump allocator for memory that lives for one frame or one worker pass.
+// Every thread allocates from its own sub-arena, so allocate() takes no lock;
+// reset() then frees everything at once. A sub-arena that runs out takes an
+// overflow block from the heap, and the next reset() grows its main block to
+// that frame's high-water mark, so after a few frames nothing reaches the heap.
+// Threads get their sub-arena slot on first use, once per process.
+// reset() must not overlap any allocate(); memory handed out before it is gone.
+class FrameArena {
+public:
+    static const int kMaxThreads = 128; // threads past this share one locked sub-arena
+
+    explicit FrameArena(size_t initialBytesPerThread = 64 * 1024);
+    ~FrameArena();
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    // alignment is a power of two, at most 64.
+    void* allocate(size_t bytes, size_t alignment = alignof(std::max_align_t));
+    template <typename T>
+    T* allocate(size_t count) { return static_cast<T*>(allocate(count * sizeof(T), alignof(T))); }
+
+    void reset();
+
+    // Bytes handed out since the last reset(), all threads.
+    size_t used() const;
+    // Most bytes handed out between two resets, all threads, and the same for the busiest sub-arena.
+    size_t highWater() const { return highWaterTotal; }
+    size_t threadHighWater() const { return highWaterThread; }
+    // Heap bytes held by the main blocks.
+    size_t reserved() const;
+
+private:
+    struct alignas(64) SubArena {
+        char* block;
+        size_t capacity;
+        size_t offset;
+        size_t overflowBytes;   // handed out from overflow blocks
+        std::vector<char*> overflow;
+    };
+
+    static int threadSlot();
+    void* allocateFrom(SubArena& arena, size_t bytes, size_t alignment);
+
+    SubArena subArenas[kMaxThreads];
+    std::mutex sharedMutex; // guards subArenas[kMaxThreads - 1]
+    size_t initialBytes;
+    size_t highWaterTotal;
+    size_t highWaterThread;
+};
+
+// Standard allocator on a FrameArena, for containers that only live for a
+// frame: ArenaVector<int> list(ArenaAllocator<int>(&arena)). deallocate() is a
+// no-op, so growth leaves the old storage behind until the reset. A null
+// arena means the heap, which keeps default-constructed containers usable.
+template <typename T>
+class ArenaAllocator {
+public:
+    typedef T value_type;
+    typedef std::true_type propagate_on_container_copy_assignment;
+    typedef std::true_type propagate_on_container_move_assignment;
+    typedef std::true_type propagate_on_container_swap;
+
+    ArenaAllocator(FrameArena* arena = nullptr) noexcept : arena(arena) {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept : arena(other.arena) {}
+
+    T* allocate(size_t count) {
+        if (arena)
+            return arena->allocate<T>(count);
+        return static_cast<T*>(::operator new(count * sizeof(T)));
+    }
+    void deallocate(T* p, size_t) noexcept {
+        if (!arena)
+            ::operator delete(p);
+    }
+
+    FrameArena* arena;
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) { return a.arena == b.arena; }
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) { return a.arena != b.arena; }
+
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T> >;
+
+#endif // FRAMEARENA_HPP
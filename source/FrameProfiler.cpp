@@ -0,0 +1,223 @@
+#include "FrameProfiler.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+RollingHistogram::RollingHistogram() : samples(kCapacity), next(0), count(0) {
+    sorted.reserve(kCapacity);
+}
+
+void RollingHistogram::record(double milliseconds) {
+    samples[next] = milliseconds;
+    next = (next + 1) % kCapacity;
+    if (count < kCapacity)
+        count++;
+}
+
+// Nearest-rank percentile over the samples held.
+double RollingHistogram::percentile(double p) const {
+    if (count == 0)
+        return 0.0;
+    sorted.assign(samples.begin(), samples.begin() + count);
+    size_t rank = (size_t)std::ceil(std::min(std::max(p, 0.0), 1.0) * count);
+    size_t k = rank > 0 ? rank - 1 : 0;
+    std::nth_element(sorted.begin(), sorted.begin() + k, sorted.end());
+    return sorted[k];
+}
+
+double RollingHistogram::max() const {
+    if (count == 0)
+        return 0.0;
+    return *std::max_element(samples.begin(), samples.begin() + count);
+}
+
+FrameProfiler::FrameProfiler() : frameIndex(0), gpuDropped(0), framesAllocating(0) {
+    frameTotal = cpuPhase("frame");
+    frameAllocationMark = AllocationCounter::allThreads();
+    frameAllocations = AllocationCounter::Counts();
+}
+
+void FrameProfiler::release() {
+    for (size_t i = 0; i < gpu.size(); ++i) {
+        Measurement& m = gpu[i];
+        if (!m.queries[0])
+            continue;
+        glDeleteQueries(kGpuLatency, m.queries);
+        for (int s = 0; s < kGpuLatency; ++s) {
+            m.queries[s] = 0;
+            m.issued[s] = false;
+        }
+    }
+}
+
+double FrameProfiler::now() {
+    typedef std::chrono::steady_clock Clock;
+    return std::chrono::duration<double, std::milli>(Clock::now().time_since_epoch()).count();
+}
+
+int FrameProfiler::addMeasurement(std::vector<Measurement>& list, const char* name) {
+    for (size_t i = 0; i < list.size(); ++i)
+        if (list[i].name == name)
+            return (int)i;
+    list.push_back(Measurement());
+    Measurement& m = list.back();
+    m.name = name;
+    m.start = 0.0;
+    m.allocationStart = m.allocations = m.lastAllocations = AllocationCounter::Counts();
+    for (int s = 0; s < kGpuLatency; ++s) {
+        m.queries[s] = 0;
+        m.issued[s] = false;
+    }
+    return (int)list.size() - 1;
+}
+
+int FrameProfiler::cpuPhase(const char* name) {
+    return addMeasurement(cpu, name);
+}
+
+int FrameProfiler::gpuPass(const char* name) {
+    return addMeasurement(gpu, name);
+}
+
+void FrameProfiler::beginFrame() {
+    // This frame reuses the slot of kGpuLatency frames ago: collect it first.
+    collectGpu(frameIndex % kGpuLatency);
+    beginCpu(frameTotal);
+}
+
+void FrameProfiler::endFrame() {
+    endCpu(frameTotal);
+    AllocationCounter::Counts all = AllocationCounter::allThreads();
+    frameAllocations = all - frameAllocationMark;
+    frameAllocationMark = all;
+    if (frameAllocations.allocations > 0)
+        framesAllocating++;
+    frameIndex++;
+}
+
+void FrameProfiler::beginCpu(int phase) {
+    cpu[phase].allocationStart = AllocationCounter::thisThread();
+    cpu[phase].start = now();
+}
+
+void FrameProfiler::endCpu(int phase) {
+    Measurement& m = cpu[phase];
+    m.histogram.record(now() - m.start);
+    m.lastAllocations = AllocationCounter::thisThread() - m.allocationStart;
+    m.allocations.allocations += m.lastAllocations.allocations;
+    m.allocations.bytes += m.lastAllocations.bytes;
+}
+
+void FrameProfiler::recordCpu(int phase, double milliseconds) {
+    cpu[phase].histogram.record(milliseconds);
+}
+
+void FrameProfiler::beginGpu(int pass) {
+    Measurement& m = gpu[pass];
+    if (!m.queries[0])
+        glGenQueries(kGpuLatency, m.queries);
+    int slot = frameIndex % kGpuLatency;
+    if (m.issued[slot])
+        return; // still waiting for a result from the last round; skip this frame
+    glBeginQuery(GL_TIME_ELAPSED, m.queries[slot]);
+}
+
+void FrameProfiler::endGpu(int pass) {
+    Measurement& m = gpu[pass];
+    int slot = frameIndex % kGpuLatency;
+    if (m.issued[slot])
+        return;
+    glEndQuery(GL_TIME_ELAPSED);
+    m.issued[slot] = true;
+}
+
+void FrameProfiler::recordMemory(const char* name, size_t bytes) {
+    for (size_t i = 0; i < memory.size(); ++i) {
+        if (memory[i].name == name) {
+            memory[i].highWater = std::max(memory[i].highWater, bytes);
+            return;
+        }
+    }
+    MemoryGauge gauge;
+    gauge.name = name;
+    gauge.highWater = bytes;
+    memory.push_back(gauge);
+}
+
+void FrameProfiler::collectGpu(int slot) {
+    for (size_t i = 0; i < gpu.size(); ++i) {
+        Measurement& m = gpu[i];
+        if (!m.issued[slot])
+            continue;
+        GLint available = 0;
+        glGetQueryObjectiv(m.queries[slot], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) {
+            // Leave it issued; this pass goes unmeasured until it is.
+            gpuDropped++;
+            continue;
+        }
+        GLuint64 elapsed = 0;
+        glGetQueryObjectui64v(m.queries[slot], GL_QUERY_RESULT, &elapsed);
+        m.histogram.record((double)elapsed * 1e-6);
+        m.issued[slot] = false;
+    }
+}
+
+void FrameProfiler::printSummary() const {
+    for (size_t i = 0; i < cpu.size(); ++i)
+        printf("  cpu %-12s p50 %7.3f  p95 %7.3f  max %7.3f ms\n", cpu[i].name.c_str(),
+               cpu[i].histogram.percentile(0.5), cpu[i].histogram.percentile(0.95), cpu[i].histogram.max());
+    for (size_t i = 0; i < gpu.size(); ++i)
+        printf("  gpu %-12s p50 %7.3f  p95 %7.3f  max %7.3f ms\n", gpu[i].name.c_str(),
+               gpu[i].histogram.percentile(0.5), gpu[i].histogram.percentile(0.95), gpu[i].histogram.max());
+    for (size_t i = 0; i < memory.size(); ++i)
+        printf("  mem %-12s high water %zu bytes\n", memory[i].name.c_str(), memory[i].highWater);
+}
+
+void FrameProfiler::printAllocations() const {
+    for (size_t i = 0; i < cpu.size(); ++i) {
+        const Measurement& m = cpu[i];
+        if (m.allocations.allocations == 0)
+            continue;
+        printf("  cpu %-12s %llu allocations (%llu bytes), last run %llu (%llu bytes)\n", m.name.c_str(),
+               (unsigned long long)m.allocations.allocations, (unsigned long long)m.allocations.bytes,
+               (unsigned long long)m.lastAllocations.allocations, (unsigned long long)m.lastAllocations.bytes);
+    }
+}
+
+void FrameProfiler::writeHistogram(FILE* file, const Measurement& m) {
+    const RollingHistogram& h = m.histogram;
+    fprintf(file, "    \"%s\": { \"samples\": %zu, \"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f }",
+            m.name.c_str(), h.size(), h.percentile(0.5), h.percentile(0.95), h.percentile(0.99), h.max());
+}
+
+// Times are in milliseconds over the last RollingHistogram::kCapacity samples.
+bool FrameProfiler::writeJson(const std::string& path) const {
+    FILE* file = fopen(path.c_str(), "w");
+    if (!file) {
+        fprintf(stderr, "Could not write profile to %s\n", path.c_str());
+        return false;
+    }
+    fprintf(file, "{\n  \"frames\": %d,\n  \"gpu_results_late\": %zu,\n  \"cpu\": {\n", frameIndex, gpuDropped);
+    for (size_t i = 0; i < cpu.size(); ++i) {
+        writeHistogram(file, cpu[i]);
+        fprintf(file, i + 1 < cpu.size() ? ",\n" : "\n");
+    }
+    fprintf(file, "  },\n  \"gpu\": {\n");
+    for (size_t i = 0; i < gpu.size(); ++i) {
+        writeHistogram(file, gpu[i]);
+        fprintf(file, i + 1 < gpu.size() ? ",\n" : "\n");
+    }
+    // Totals over the whole run; all zero unless built with P2_COUNT_ALLOCATIONS.
+    fprintf(file, "  },\n  \"allocations\": {\n    \"counted\": %s,\n    \"frames_allocating\": %zu",
+            AllocationCounter::compiledIn() ? "true" : "false", framesAllocating);
+    for (size_t i = 0; i < cpu.size(); ++i)
+        fprintf(file, ",\n    \"%s\": { \"count\": %llu, \"bytes\": %llu }", cpu[i].name.c_str(),
+                (unsigned long long)cpu[i].allocations.allocations, (unsigned long long)cpu[i].allocations.bytes);
+    fprintf(file, "\n  },\n  \"memory_high_water\": {");
+    for (size_t i = 0; i < memory.size(); ++i)
+        fprintf(file, "%s\n    \"%s\": %zu", i ? "," : "", memory[i].name.c_str(), memory[i].highWater);
+    fprintf(file, "\n  }\n}\n");
+    fclose(file);
+    return true;
+}
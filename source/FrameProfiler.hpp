@@ -0,0 +1,121 @@
+#ifndef FRAMEPROFILER_HPP
+#define FRAMEPROFILER_HPP
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <GL/glew.h>
+#include "AllocationCounter.hpp"
+
+// The last kCapacity samples of one measurement, in milliseconds, with
+// percentiles over them. Recording never allocates.
+class RollingHistogram {
+public:
+    static const size_t kCapacity = 1024;
+
+    RollingHistogram();
+
+    void record(double milliseconds);
+    void clear() { next = count = 0; }
+    size_t size() const { return count; }
+    // p in [0, 1]; 0 when empty.
+    double percentile(double p) const;
+    double max() const;
+
+private:
+    std::vector<double> samples;
+    size_t next;
+    size_t count;
+    mutable std::vector<double> sorted; // scratch for percentile()
+};
+
+// Per-frame timing. CPU phases are timed with steady_clock; GPU passes with
+// GL_TIME_ELAPSED queries, kept in a ring and read back kGpuLatency frames
+// later so the CPU never waits for the GPU. Every phase and pass feeds its own
+// rolling histogram; "frame" is the CPU time from beginFrame() to endFrame().
+// GPU passes must not nest: GL allows one time-elapsed query at a time.
+// With P2_COUNT_ALLOCATIONS (AllocationCounter.hpp) each CPU phase also
+// counts the heap allocations it made, and each frame those of every thread.
+// Memory gauges keep the largest value reported under a name, e.g. the
+// high-water mark of a frame arena.
+class FrameProfiler {
+public:
+    static const int kGpuLatency = 4;
+
+    FrameProfiler();
+
+    // Deletes the GPU queries. Call before the context goes away; a later
+    // beginGpu() creates them again.
+    void release();
+
+    // Ids are stable; registering a name twice returns the first id.
+    int cpuPhase(const char* name);
+    int gpuPass(const char* name);
+
+    void beginFrame();
+    void endFrame();
+
+    void beginCpu(int phase);
+    void endCpu(int phase);
+    // Adds a sample measured elsewhere, e.g. on another thread.
+    void recordCpu(int phase, double milliseconds);
+
+    void beginGpu(int pass);
+    void endGpu(int pass);
+
+    // Keeps the maximum of the bytes reported under this name.
+    void recordMemory(const char* name, size_t bytes);
+
+    // Allocations by every thread since the previous endFrame(), as of the last endFrame().
+    AllocationCounter::Counts lastFrameAllocations() const { return frameAllocations; }
+    size_t allocatingFrames() const { return framesAllocating; }
+
+    // One line of "name p50/p95/max" per measurement.
+    void printSummary() const;
+    // One line per CPU phase that allocated: totals and its last run.
+    void printAllocations() const;
+    bool writeJson(const std::string& path) const;
+
+    // RAII helper for a CPU phase.
+    class CpuScope {
+    public:
+        CpuScope(FrameProfiler& profiler, int phase) : profiler(profiler), phase(phase) { profiler.beginCpu(phase); }
+        ~CpuScope() { profiler.endCpu(phase); }
+
+    private:
+        FrameProfiler& profiler;
+        int phase;
+    };
+
+private:
+    struct Measurement {
+        std::string name;
+        RollingHistogram histogram;
+        double start;                // CPU phases
+        AllocationCounter::Counts allocationStart, allocations, lastAllocations; // CPU phases, this thread
+        GLuint queries[kGpuLatency]; // GPU passes, one per frame in flight
+        bool issued[kGpuLatency];
+    };
+
+    static double now();
+    static void writeHistogram(FILE* file, const Measurement& m);
+    int addMeasurement(std::vector<Measurement>& list, const char* name);
+    void collectGpu(int slot);
+
+    struct MemoryGauge {
+        std::string name;
+        size_t highWater;
+    };
+
+    std::vector<Measurement> cpu;
+    std::vector<Measurement> gpu;
+    std::vector<MemoryGauge> memory;
+    int frameIndex;
+    int frameTotal; // cpu phase for the whole frame
+    size_t gpuDropped; // results still not ready when their slot came round again
+    AllocationCounter::Counts frameAllocationMark; // all threads, at the last endFrame()
+    AllocationCounter::Counts frameAllocations;
+    size_t framesAllocating;
+};
+
+#endif // FRAMEPROFILER_HPP
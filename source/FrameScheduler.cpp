@@ -0,0 +1,31 @@
+#include "FrameScheduler.hpp"
+#include <GLFW/glfw3.h>
+
+FrameScheduler::FrameScheduler() : mode(Mode::OnDemand), dirty(true) {
+}
+
+void FrameScheduler::setMode(Mode newMode) {
+    mode = newMode;
+    dirty = true;
+}
+
+void FrameScheduler::markDirty() {
+    dirty = true;
+}
+
+bool FrameScheduler::shouldDraw() const {
+    return mode == Mode::Continuous || dirty;
+}
+
+void FrameScheduler::waitForFrame() {
+    if (shouldDraw()) {
+        glfwPollEvents();
+        return;
+    }
+    // Every frame trigger is an event; glfwPostEmptyEvent() from the worker wakes us.
+    glfwWaitEvents();
+}
+
+void FrameScheduler::frameDrawn() {
+    dirty = false;
+}
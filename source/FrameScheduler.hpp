@@ -0,0 +1,32 @@
+#ifndef FRAMESCHEDULER_HPP
+#define FRAMESCHEDULER_HPP
+
+// Decides when the render loop draws. In OnDemand mode a frame is drawn only
+// after markDirty(), which the input callbacks call when they change the
+// scene and the loop calls when curveWorker.frameReady() reports new
+// geometry; otherwise waitForFrame() sleeps in GLFW until an event arrives
+// (the worker posts an empty one when it finishes). Continuous mode draws
+// every iteration, for benchmarks.
+class FrameScheduler {
+public:
+    enum class Mode { OnDemand, Continuous };
+
+    FrameScheduler();
+
+    void setMode(Mode newMode);
+    Mode getMode() const { return mode; }
+
+    // The scene changed: draw at least one more frame.
+    void markDirty();
+    // Processes pending window events; blocks for the next one if no frame is needed.
+    void waitForFrame();
+    bool shouldDraw() const;
+    // Call after a frame was drawn and presented.
+    void frameDrawn();
+
+private:
+    Mode mode;
+    bool dirty;
+};
+
+#endif // FRAMESCHEDULER_HPP
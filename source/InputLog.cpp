@@ -0,0 +1,164 @@
+#include "InputLog.hpp"
+#include <cstring>
+
+namespace {
+
+const size_t kHeaderBytes = 16;
+const size_t kRecordBytes = 31;
+
+void putU32(unsigned char* p, uint32_t v) {
+    for (int i = 0; i < 4; ++i)
+        p[i] = (unsigned char)(v >> (8 * i));
+}
+
+void putU64(unsigned char* p, uint64_t v) {
+    for (int i = 0; i < 8; ++i)
+        p[i] = (unsigned char)(v >> (8 * i));
+}
+
+uint32_t getU32(const unsigned char* p) {
+    uint32_t v = 0;
+    for (int i = 0; i < 4; ++i)
+        v |= (uint32_t)p[i] << (8 * i);
+    return v;
+}
+
+uint64_t getU64(const unsigned char* p) {
+    uint64_t v = 0;
+    for (int i = 0; i < 8; ++i)
+        v |= (uint64_t)p[i] << (8 * i);
+    return v;
+}
+
+void putF32(unsigned char* p, float f) {
+    uint32_t v;
+    memcpy(&v, &f, 4);
+    putU32(p, v);
+}
+
+void putF64(unsigned char* p, double d) {
+    uint64_t v;
+    memcpy(&v, &d, 8);
+    putU64(p, v);
+}
+
+float getF32(const unsigned char* p) {
+    uint32_t v = getU32(p);
+    float f;
+    memcpy(&f, &v, 4);
+    return f;
+}
+
+double getF64(const unsigned char* p) {
+    uint64_t v = getU64(p);
+    double d;
+    memcpy(&d, &v, 8);
+    return d;
+}
+
+} // namespace
+
+InputRecorder::InputRecorder() : file(nullptr), count(0) {
+}
+
+InputRecorder::~InputRecorder() {
+    close();
+}
+
+bool InputRecorder::open(const std::string& path, int windowWidth, int windowHeight) {
+    close();
+    file = fopen(path.c_str(), "wb");
+    if (!file) {
+        fprintf(stderr, "Could not write input log %s\n", path.c_str());
+        return false;
+    }
+    unsigned char header[kHeaderBytes];
+    memcpy(header, "P2IN", 4);
+    putU32(header + 4, kInputLogVersion);
+    putU32(header + 8, (uint32_t)windowWidth);
+    putU32(header + 12, (uint32_t)windowHeight);
+    fwrite(header, 1, kHeaderBytes, file);
+    count = 0;
+    return true;
+}
+
+void InputRecorder::close() {
+    if (file)
+        fclose(file);
+    file = nullptr;
+}
+
+void InputRecorder::record(const InputEvent& event, uint32_t frame, double frameStart) {
+    if (!file)
+        return;
+    unsigned char r[kRecordBytes];
+    putU32(r, frame);
+    putF32(r + 4, (float)(event.time - frameStart));
+    r[8] = (unsigned char)event.type;
+    r[9] = (unsigned char)(signed char)event.action;
+    r[10] = (unsigned char)event.mods;
+    putU32(r + 11, (uint32_t)event.code);
+    putF64(r + 15, event.x);
+    putF64(r + 23, event.y);
+    fwrite(r, 1, kRecordBytes, file);
+    count++;
+}
+
+InputReplayer::InputReplayer() : loaded(false), width(0), height(0), cursor(0) {
+}
+
+bool InputReplayer::open(const std::string& path) {
+    loaded = false;
+    records.clear();
+    cursor = 0;
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file) {
+        fprintf(stderr, "Could not read input log %s\n", path.c_str());
+        return false;
+    }
+    unsigned char header[kHeaderBytes];
+    if (fread(header, 1, kHeaderBytes, file) != kHeaderBytes || memcmp(header, "P2IN", 4) != 0 ||
+        getU32(header + 4) != kInputLogVersion) {
+        fprintf(stderr, "%s is not a version %u input log\n", path.c_str(), kInputLogVersion);
+        fclose(file);
+        return false;
+    }
+    width = (int)getU32(header + 8);
+    height = (int)getU32(header + 12);
+
+    unsigned char r[kRecordBytes];
+    size_t got;
+    while ((got = fread(r, 1, kRecordBytes, file)) == kRecordBytes) {
+        Record record;
+        record.frame = getU32(r);
+        record.offset = getF32(r + 4);
+        record.event.type = (InputEvent::Type)r[8];
+        record.event.action = (signed char)r[9];
+        record.event.mods = r[10];
+        record.event.code = (int)getU32(r + 11);
+        record.event.x = getF64(r + 15);
+        record.event.y = getF64(r + 23);
+        record.event.time = 0.0;
+        if (record.event.type > InputEvent::WindowSize || (!records.empty() && record.frame < records.back().frame)) {
+            fprintf(stderr, "%s: corrupt record %zu\n", path.c_str(), records.size());
+            fclose(file);
+            records.clear();
+            return false;
+        }
+        records.push_back(record);
+    }
+    fclose(file);
+    if (got != 0)
+        fprintf(stderr, "%s: ignoring a truncated last record\n", path.c_str());
+    loaded = true;
+    return true;
+}
+
+bool InputReplayer::next(uint32_t frame, double frameStart, InputEvent& event) {
+    if (cursor == records.size() || records[cursor].frame > frame)
+        return false;
+    event = records[cursor].event;
+    event.time = frameStart + records[cursor].offset;
+    cursor++;
+    return true;
+}
@@ -0,0 +1,69 @@
+#ifndef INPUTLOG_HPP
+#define INPUTLOG_HPP
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "InputQueue.hpp"
+
+// Binary input session log, for replaying an editing session exactly.
+//
+// Layout, all little-endian:
+//   header: "P2IN", u32 version, u32 window width, u32 window height
+//   record: u32 frame, f32 offset, u8 type, i8 action, u8 mods, i32 code, f64 x, f64 y
+// frame counts drawn frames since recording started; an event belongs to the
+// frame it was handled before. offset is its time in seconds after the
+// previous frame was presented (the start of its frame). Positions stay
+// doubles so a replay hands the app exactly the values GLFW gave it.
+const uint32_t kInputLogVersion = 1;
+
+class InputRecorder {
+public:
+    InputRecorder();
+    ~InputRecorder();
+
+    bool open(const std::string& path, int windowWidth, int windowHeight);
+    void close();
+    bool isOpen() const { return file != nullptr; }
+
+    void record(const InputEvent& event, uint32_t frame, double frameStart);
+    size_t recordCount() const { return count; }
+
+private:
+    FILE* file;
+    size_t count;
+};
+
+class InputReplayer {
+public:
+    InputReplayer();
+
+    // Reads the whole log. Prints why on failure.
+    bool open(const std::string& path);
+    bool isOpen() const { return loaded; }
+
+    int windowWidth() const { return width; }
+    int windowHeight() const { return height; }
+
+    // The next event of the given frame, its time rebased to frameStart.
+    // Returns false once the frame has no more events.
+    bool next(uint32_t frame, double frameStart, InputEvent& event);
+    // Every event has been handed out.
+    bool finished() const { return cursor == records.size(); }
+    uint32_t frameCount() const { return records.empty() ? 0 : records.back().frame + 1; }
+
+private:
+    struct Record {
+        uint32_t frame;
+        float offset;
+        InputEvent event;
+    };
+
+    bool loaded;
+    int width, height;
+    std::vector<Record> records;
+    size_t cursor;
+};
+
+#endif // INPUTLOG_HPP
@@ -0,0 +1,65 @@
+#ifndef INPUTQUEUE_HPP
+#define INPUTQUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// One input event as reported by a GLFW callback, stamped with glfwGetTime()
+// when the callback ran.
+struct InputEvent {
+    enum Type : uint8_t { MouseButton, CursorPos, Key, Scroll, WindowSize };
+
+    Type type;
+    int code;   // mouse button or key
+    int action; // GLFW_PRESS, GLFW_RELEASE or GLFW_REPEAT
+    int mods;
+    double x, y; // cursor position in window coordinates, scroll offsets or window size
+    double time; // seconds
+};
+
+// Bounded single-producer/single-consumer ring. push() and pop() never block
+// and never allocate; a full ring rejects the event and counts it as dropped.
+// Capacity must be a power of two.
+template <typename T, size_t Capacity>
+class SpscRing {
+    static_assert((Capacity & (Capacity - 1)) == 0, "SpscRing capacity must be a power of two");
+
+public:
+    SpscRing() : head(0), tail(0), dropped(0) {}
+
+    // Producer side.
+    bool push(const T& item) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) == Capacity) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        items[t & (Capacity - 1)] = item;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side.
+    bool pop(T& item) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire))
+            return false;
+        item = items[h & (Capacity - 1)];
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t droppedCount() const { return dropped.load(std::memory_order_relaxed); }
+
+private:
+    T items[Capacity];
+    // Each index on its own cache line so producer and consumer do not share one.
+    alignas(64) std::atomic<size_t> head;
+    alignas(64) std::atomic<size_t> tail;
+    std::atomic<size_t> dropped;
+};
+
+typedef SpscRing<InputEvent, 1024> InputQueue;
+
+#endif // INPUTQUEUE_HPP
@@ -0,0 +1,204 @@
+#include "JobSystem.hpp"
+#include "Trace.hpp"
+#include <algorithm>
+
+namespace {
+
+// Which pool, if any, the current thread works for.
+thread_local const JobSystem* currentPool = nullptr;
+thread_local int currentIndex = 0;
+
+} // namespace
+
+JobSystem::JobSystem(int workerCount) : queued(0), stopping(false) {
+    if (workerCount < 0)
+        workerCount = std::max((int)std::thread::hardware_concurrency() - 1, 0);
+    for (int i = 0; i <= workerCount; ++i)
+        queues.push_back(std::unique_ptr<Queue>(new Queue()));
+    for (int i = 1; i <= workerCount; ++i)
+        workers.push_back(std::thread(&JobSystem::workerLoop, this, i));
+}
+
+JobSystem::~JobSystem() {
+    stopping.store(true);
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+    }
+    sleepCondition.notify_all();
+    for (size_t i = 0; i < workers.size(); ++i)
+        workers[i].join();
+}
+
+int JobSystem::currentThreadIndex() const {
+    return currentPool == this ? currentIndex : 0;
+}
+
+void JobSystem::submit(JobFunction fn, void* context, size_t begin, size_t end, Counter* counter) {
+    Job job = { fn, context, begin, end, counter };
+    Queue& queue = *queues[currentThreadIndex()];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tail - queue.head < kQueueCapacity) {
+            queue.ring[queue.tail++ % kQueueCapacity] = job;
+            queued.fetch_add(1, std::memory_order_release);
+            job.fn = nullptr;
+        }
+    }
+    if (!job.fn) {
+        // A worker checks queued under sleepMutex before it sleeps, so taking
+        // the lock here means it either sees the job or gets the notify.
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+        }
+        sleepCondition.notify_one();
+        return;
+    }
+    execute(job); // queue full: no point adding to the backlog
+}
+
+bool JobSystem::popOwn(int self, Job& job) {
+    Queue& queue = *queues[self];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.head == queue.tail)
+        return false;
+    job = queue.ring[--queue.tail % kQueueCapacity];
+    queued.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool JobSystem::steal(int self, Job& job) {
+    int n = (int)queues.size();
+    for (int k = 1; k < n; ++k) {
+        Queue& queue = *queues[(self + k) % n];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.head == queue.tail)
+            continue;
+        job = queue.ring[queue.head++ % kQueueCapacity];
+        queued.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+bool JobSystem::runOne(int self) {
+    Job job;
+    if (!popOwn(self, job) && !steal(self, job))
+        return false;
+    execute(job);
+    return true;
+}
+
+void JobSystem::execute(const Job& job) {
+    job.fn(job.context, job.begin, job.end);
+    if (job.counter)
+        job.counter->pending.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+void JobSystem::wait(Counter& counter) {
+    int self = currentThreadIndex();
+    while (counter.pending.load(std::memory_order_acquire) > 0) {
+        if (!runOne(self))
+            std::this_thread::yield();
+    }
+}
+
+void JobSystem::workerLoop(int index) {
+    currentPool = this;
+    currentIndex = index;
+    TRACE_THREAD_NAME("job worker");
+    while (!stopping.load(std::memory_order_relaxed)) {
+        if (runOne(index))
+            continue;
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        sleepCondition.wait(lock, [this] {
+            return queued.load(std::memory_order_acquire) > 0 || stopping.load(std::memory_order_relaxed);
+        });
+    }
+}
+
+TaskGraph::TaskId TaskGraph::addNode(const char* name, bool parallel, size_t grain) {
+    std::unique_ptr<Node> node(new Node());
+    node->graph = this;
+    node->name = name;
+    node->parallel = parallel;
+    node->grain = grain < 1 ? 1 : grain;
+    node->count = 0;
+    node->dependencies = 0;
+    nodes.push_back(std::move(node));
+    return (TaskId)nodes.size() - 1;
+}
+
+TaskGraph::TaskId TaskGraph::addTask(const char* name, std::function<void()> work) {
+    TaskId id = addNode(name, false, 1);
+    nodes[id]->work = std::move(work);
+    return id;
+}
+
+TaskGraph::TaskId TaskGraph::addParallelTask(const char* name, size_t grain, std::function<void(size_t, size_t)> work) {
+    TaskId id = addNode(name, true, grain);
+    nodes[id]->rangeWork = std::move(work);
+    return id;
+}
+
+void TaskGraph::setCount(TaskId task, size_t count) {
+    nodes[task]->count = count;
+}
+
+void TaskGraph::precede(TaskId before, TaskId after) {
+    nodes[before]->successors.push_back(after);
+    nodes[after]->dependencies++;
+}
+
+void TaskGraph::run(JobSystem& jobSystem) {
+    jobs = &jobSystem;
+    unfinished.pending.store((int)nodes.size(), std::memory_order_relaxed);
+    for (size_t i = 0; i < nodes.size(); ++i)
+        nodes[i]->remainingDependencies.store(nodes[i]->dependencies, std::memory_order_relaxed);
+    for (size_t i = 0; i < nodes.size(); ++i)
+        if (nodes[i]->dependencies == 0)
+            schedule(*nodes[i]);
+    jobs->wait(unfinished);
+}
+
+void TaskGraph::schedule(Node& node) {
+    if (!node.parallel) {
+        jobs->submit(&TaskGraph::runTask, &node, 0, 0, nullptr);
+        return;
+    }
+    size_t chunks = (node.count + node.grain - 1) / node.grain;
+    if (chunks == 0) {
+        finish(node);
+        return;
+    }
+    node.remainingChunks.store(chunks, std::memory_order_relaxed);
+    for (size_t c = 0; c < chunks; ++c)
+        jobs->submit(&TaskGraph::runChunk, &node, c * node.grain, std::min((c + 1) * node.grain, node.count), nullptr);
+}
+
+void TaskGraph::finish(Node& node) {
+    for (size_t i = 0; i < node.successors.size(); ++i) {
+        Node& next = *nodes[node.successors[i]];
+        if (next.remainingDependencies.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            schedule(next);
+    }
+    unfinished.pending.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+void TaskGraph::runTask(void* context, size_t, size_t) {
+    Node& node = *static_cast<Node*>(context);
+    {
+        TRACE_SCOPE(node.name);
+        node.work();
+    }
+    node.graph->finish(node);
+}
+
+void TaskGraph::runChunk(void* context, size_t begin, size_t end) {
+    Node& node = *static_cast<Node*>(context);
+    {
+        TRACE_SCOPE(node.name);
+        node.rangeWork(begin, end);
+    }
+    if (node.remainingChunks.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        node.graph->finish(node);
+}
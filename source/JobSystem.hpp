@@ -0,0 +1,143 @@
+#ifndef JOBSYSTEM_HPP
+#define JOBSYSTEM_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Thread pool with one job deque per thread and work stealing. A thread
+// pushes and pops at the back of its own deque and steals from the front of
+// the others', so freshly split work stays hot in the splitting core while
+// idle threads take the oldest, largest pieces. Threads that are not pool
+// workers share deque 0. Waiting never just blocks: wait() runs queued jobs
+// until the awaited counter reaches zero, so jobs may wait on jobs they spawn.
+class JobSystem {
+public:
+    typedef void (*JobFunction)(void* context, size_t begin, size_t end);
+
+    // Counts the unfinished jobs of one batch.
+    struct Counter {
+        std::atomic<int> pending;
+        Counter() : pending(0) {}
+    };
+
+    // workerCount < 0 starts one worker per hardware thread, less the caller's.
+    explicit JobSystem(int workerCount = -1);
+    ~JobSystem();
+
+    // Pool workers plus the calling thread.
+    int threadCount() const { return (int)queues.size(); }
+    // 1 .. workers on pool threads, 0 anywhere else. Stable for the job's duration,
+    // so it can index per-thread scratch.
+    int currentThreadIndex() const;
+
+    // Queues fn(context, begin, end); counter->pending must already include it.
+    void submit(JobFunction fn, void* context, size_t begin, size_t end, Counter* counter);
+    // Runs jobs until counter->pending is zero.
+    void wait(Counter& counter);
+
+    // Runs fn(begin, end) over [0, count) in chunks of at most grain items and
+    // returns when all are done. The calling thread takes part.
+    template <typename F>
+    void parallelFor(size_t count, size_t grain, const F& fn);
+
+private:
+    struct Job {
+        JobFunction fn;
+        void* context;
+        size_t begin, end;
+        Counter* counter;
+    };
+    // Fixed-size ring used as a deque; a full ring makes submit() run the job inline.
+    struct Queue {
+        std::mutex mutex;
+        std::vector<Job> ring;
+        size_t head, tail;
+        Queue() : ring(kQueueCapacity), head(0), tail(0) {}
+    };
+    static const size_t kQueueCapacity = 4096;
+
+    bool popOwn(int self, Job& job);
+    bool steal(int self, Job& job);
+    bool runOne(int self);
+    static void execute(const Job& job);
+    void workerLoop(int index);
+
+    std::vector<std::unique_ptr<Queue> > queues;
+    std::vector<std::thread> workers;
+    std::atomic<int> queued;
+    std::atomic<bool> stopping;
+    std::mutex sleepMutex;
+    std::condition_variable sleepCondition;
+};
+
+template <typename F>
+void JobSystem::parallelFor(size_t count, size_t grain, const F& fn) {
+    if (grain < 1)
+        grain = 1;
+    size_t chunks = (count + grain - 1) / grain;
+    if (chunks <= 1 || workers.empty()) {
+        if (count > 0)
+            fn((size_t)0, count);
+        return;
+    }
+    JobFunction trampoline = [](void* context, size_t begin, size_t end) {
+        (*static_cast<const F*>(context))(begin, end);
+    };
+    Counter counter;
+    counter.pending.store((int)chunks - 1, std::memory_order_relaxed);
+    for (size_t c = 1; c < chunks; ++c)
+        submit(trampoline, (void*)&fn, c * grain, c + 1 < chunks ? (c + 1) * grain : count, &counter);
+    fn((size_t)0, grain);
+    wait(counter);
+}
+
+// A set of tasks with dependencies, built once and run every frame. A
+// parallel task is split into chunks on the job system; its item count may be
+// changed before each run. run() returns when every task has finished.
+class TaskGraph {
+public:
+    typedef int TaskId;
+
+    TaskId addTask(const char* name, std::function<void()> work);
+    TaskId addParallelTask(const char* name, size_t grain, std::function<void(size_t, size_t)> work);
+    void setCount(TaskId task, size_t count);
+    // after starts only once before has finished.
+    void precede(TaskId before, TaskId after);
+
+    void run(JobSystem& jobs);
+
+    const char* name(TaskId task) const { return nodes[task]->name; }
+
+private:
+    struct Node {
+        TaskGraph* graph;
+        const char* name;
+        bool parallel;
+        size_t grain;
+        size_t count;
+        std::function<void()> work;
+        std::function<void(size_t, size_t)> rangeWork;
+        std::vector<TaskId> successors;
+        int dependencies;
+        std::atomic<int> remainingDependencies;
+        std::atomic<size_t> remainingChunks;
+    };
+
+    TaskId addNode(const char* name, bool parallel, size_t grain);
+    void schedule(Node& node);
+    void finish(Node& node);
+    static void runTask(void* context, size_t begin, size_t end);
+    static void runChunk(void* context, size_t begin, size_t end);
+
+    std::vector<std::unique_ptr<Node> > nodes;
+    JobSystem* jobs;
+    JobSystem::Counter unfinished; // tasks of the current run
+};
+
+#endif // JOBSYSTEM_HPP
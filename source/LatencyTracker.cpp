@@ -0,0 +1,214 @@
+#include "LatencyTracker.hpp"
+#include <GLFW/glfw3.h>
+#include <cmath>
+#include <cstdio>
+
+namespace {
+
+const char* const kStageNames[LatencyTracker::StageCount] = { "update", "tessellated", "swap", "gpu" };
+
+} // namespace
+
+LatencyTracker::LatencyTracker()
+    : gpuClockOffset(0.0), dragIndex(0), dragging(false), dragOpen(false), dragMoves(0), dragMissingGpu(0) {
+    for (int i = 0; i < kFencesInFlight; ++i) {
+        fences[i].sync = 0;
+        fences[i].query = 0;
+    }
+}
+
+void LatencyTracker::release() {
+    for (int i = 0; i < kFencesInFlight; ++i) {
+        if (fences[i].sync)
+            glDeleteSync(fences[i].sync);
+        if (fences[i].query)
+            glDeleteQueries(1, &fences[i].query);
+        fences[i].sync = 0;
+        fences[i].query = 0;
+    }
+    for (size_t i = 0; i < samples.size(); ++i) {
+        if (samples[i].state == Swapped) {
+            samples[i].fence = -1;
+            samples[i].state = Done;
+        }
+    }
+}
+
+// GL_TIMESTAMP counts GPU nanoseconds from an arbitrary origin; pair it with
+// the CPU clock once per drag so drift cannot build up.
+void LatencyTracker::calibrateGpuClock() {
+    GLint64 gpuNow = 0;
+    glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+    gpuClockOffset = glfwGetTime() - (double)gpuNow * 1e-9;
+}
+
+void LatencyTracker::beginDrag() {
+    if (dragOpen)
+        finishDrag(); // the last drag's stragglers go uncounted
+    calibrateGpuClock();
+    dragIndex++;
+    dragging = true;
+    dragOpen = true;
+    dragMoves = 0;
+    dragMissingGpu = 0;
+    for (int s = 0; s < StageCount; ++s)
+        dragStages[s].clear();
+}
+
+void LatencyTracker::endDrag() {
+    dragging = false;
+    if (dragOpen && samples.empty())
+        finishDrag();
+}
+
+void LatencyTracker::inputHandled(double inputTime) {
+    if (!dragging)
+        return;
+    Sample sample;
+    sample.drag = dragIndex;
+    sample.state = Handled;
+    sample.sequence = 0;
+    sample.fence = -1;
+    sample.input = inputTime;
+    sample.stage[Update] = glfwGetTime();
+    for (int s = Tessellated; s < StageCount; ++s)
+        sample.stage[s] = 0.0;
+    samples.push_back(sample);
+}
+
+void LatencyTracker::submitted(uint64_t sequence) {
+    for (std::vector<Sample>::reverse_iterator it = samples.rbegin(); it != samples.rend() && it->state == Handled; ++it) {
+        it->state = Submitted;
+        it->sequence = sequence;
+    }
+}
+
+void LatencyTracker::presented(uint64_t sequence) {
+    double now = glfwGetTime();
+    for (size_t i = 0; i < samples.size(); ++i) {
+        Sample& sample = samples[i];
+        if (sample.state == Submitted && sample.sequence <= sequence) {
+            sample.state = Presented;
+            sample.stage[Tessellated] = now;
+        }
+    }
+}
+
+void LatencyTracker::swapped() {
+    double now = glfwGetTime();
+    int slot = -1;
+    for (size_t i = 0; i < samples.size(); ++i) {
+        Sample& sample = samples[i];
+        if (sample.state != Presented)
+            continue;
+        if (slot < 0) {
+            // One fence and timestamp for every sample this frame shows.
+            for (int f = 0; f < kFencesInFlight && slot < 0; ++f)
+                if (!fences[f].sync)
+                    slot = f;
+            if (slot >= 0) {
+                if (!fences[slot].query)
+                    glGenQueries(1, &fences[slot].query);
+                glQueryCounter(fences[slot].query, GL_TIMESTAMP);
+                fences[slot].sync = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            } else {
+                slot = kFencesInFlight; // none free: these samples get no GPU time
+            }
+        }
+        sample.state = Swapped;
+        sample.stage[Swap] = now;
+        sample.fence = slot < kFencesInFlight ? slot : -1;
+        if (sample.fence < 0)
+            sample.state = Done;
+    }
+}
+
+void LatencyTracker::poll() {
+    for (int f = 0; f < kFencesInFlight; ++f) {
+        if (!fences[f].sync)
+            continue;
+        GLenum status = glClientWaitSync(fences[f].sync, 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+            continue;
+        glDeleteSync(fences[f].sync);
+        fences[f].sync = 0;
+        GLuint64 gpuTime = 0;
+        glGetQueryObjectui64v(fences[f].query, GL_QUERY_RESULT, &gpuTime);
+        double completed = (double)gpuTime * 1e-9 + gpuClockOffset;
+        for (size_t i = 0; i < samples.size(); ++i) {
+            if (samples[i].state == Swapped && samples[i].fence == f) {
+                samples[i].stage[Gpu] = completed;
+                samples[i].state = Done;
+            }
+        }
+    }
+
+    size_t done = 0;
+    for (; done < samples.size() && samples[done].state == Done; ++done) {
+        const Sample& sample = samples[done];
+        if (sample.drag == dragIndex && dragOpen) {
+            dragMoves++;
+            for (int s = 0; s < StageCount; ++s) {
+                if (s == Gpu && sample.fence < 0) {
+                    dragMissingGpu++;
+                    continue;
+                }
+                double ms = (sample.stage[s] - sample.input) * 1e3;
+                dragStages[s].record(ms);
+                allStages[s].record(ms);
+            }
+        }
+    }
+    samples.erase(samples.begin(), samples.begin() + done);
+    if (dragOpen && !dragging && samples.empty())
+        finishDrag();
+}
+
+void LatencyTracker::finishDrag() {
+    dragOpen = false;
+    samples.clear();
+    if (dragMoves == 0)
+        return;
+    DragStats stats;
+    stats.index = dragIndex;
+    stats.moves = dragMoves;
+    stats.missingGpu = dragMissingGpu;
+    for (int s = 0; s < StageCount; ++s) {
+        stats.p50[s] = dragStages[s].percentile(0.5);
+        stats.p95[s] = dragStages[s].percentile(0.95);
+        stats.p99[s] = dragStages[s].percentile(0.99);
+        stats.max[s] = dragStages[s].max();
+    }
+    drags.push_back(stats);
+    printf("drag %d: %zu moves, input to swap p50 %.2f p95 %.2f ms, to gpu p50 %.2f p95 %.2f max %.2f ms\n", stats.index,
+           stats.moves, stats.p50[Swap], stats.p95[Swap], stats.p50[Gpu], stats.p95[Gpu], stats.max[Gpu]);
+}
+
+// Milliseconds from the input event to each stage.
+bool LatencyTracker::writeJson(const std::string& path) const {
+    FILE* file = fopen(path.c_str(), "w");
+    if (!file) {
+        fprintf(stderr, "Could not write latency report to %s\n", path.c_str());
+        return false;
+    }
+    fprintf(file, "{\n  \"drags\": [");
+    for (size_t d = 0; d < drags.size(); ++d) {
+        const DragStats& stats = drags[d];
+        fprintf(file, "%s\n    { \"drag\": %d, \"moves\": %zu, \"missing_gpu\": %zu", d ? "," : "", stats.index, stats.moves,
+                stats.missingGpu);
+        for (int s = 0; s < StageCount; ++s)
+            fprintf(file, ", \"%s\": { \"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f }", kStageNames[s],
+                    stats.p50[s], stats.p95[s], stats.p99[s], stats.max[s]);
+        fprintf(file, " }");
+    }
+    fprintf(file, "\n  ],\n  \"all\": {\n");
+    for (int s = 0; s < StageCount; ++s) {
+        const RollingHistogram& h = allStages[s];
+        fprintf(file, "    \"%s\": { \"samples\": %zu, \"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f }%s\n",
+                kStageNames[s], h.size(), h.percentile(0.5), h.percentile(0.95), h.percentile(0.99), h.max(),
+                s + 1 < StageCount ? "," : "");
+    }
+    fprintf(file, "  }\n}\n");
+    fclose(file);
+    return true;
+}
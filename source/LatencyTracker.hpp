@@ -0,0 +1,87 @@
+#ifndef LATENCYTRACKER_HPP
+#define LATENCYTRACKER_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <GL/glew.h>
+#include "FrameProfiler.hpp"
+
+// Input-to-photon latency of point drags. Every cursor event that moves the
+// dragged point becomes a sample, timed from the event's glfwGetTime() stamp
+// to four later points:
+//   update      the event was handled and the point moved (updatePoint)
+//   tessellated the curve worker's frame built from that edit was uploaded
+//   swap        glfwSwapBuffers returned for the frame that shows it
+//   gpu         the GPU passed a timestamp query placed after that swap,
+//               read back once a fence says so, mapped to the CPU clock
+// Each drag gets its own distribution, printed once its last sample is in.
+// Nothing here waits on the GPU.
+class LatencyTracker {
+public:
+    enum Stage { Update, Tessellated, Swap, Gpu, StageCount };
+    static const int kFencesInFlight = 8;
+
+    LatencyTracker();
+
+    // Deletes the fences and queries; samples still waiting on them finish
+    // without a GPU time. Call before the context goes away.
+    void release();
+
+    void beginDrag();
+    void endDrag();
+
+    // A drag event was handled; inputTime is its timestamp.
+    void inputHandled(double inputTime);
+    // The edits handled so far went to the curve worker as input `sequence`.
+    void submitted(uint64_t sequence);
+    // A worker frame reflecting inputs up to `sequence` was uploaded.
+    void presented(uint64_t sequence);
+    // Right after glfwSwapBuffers.
+    void swapped();
+    // Collects finished fences; call once per loop iteration.
+    void poll();
+
+    bool writeJson(const std::string& path) const;
+
+private:
+    enum State { Handled, Submitted, Presented, Swapped, Done };
+
+    struct Sample {
+        int drag;
+        State state;
+        uint64_t sequence;
+        int fence; // slot in fences once swapped, -1 when none was free
+        double input;
+        double stage[StageCount]; // seconds, glfwGetTime() clock
+    };
+
+    struct Fence {
+        GLsync sync;
+        GLuint query;
+    };
+
+    struct DragStats {
+        int index;
+        size_t moves;
+        size_t missingGpu; // swapped while every fence was in use
+        double p50[StageCount], p95[StageCount], p99[StageCount], max[StageCount];
+    };
+
+    void calibrateGpuClock();
+    void finishDrag();
+
+    std::vector<Sample> samples; // oldest first; they complete in order. Capacity is kept.
+    Fence fences[kFencesInFlight];
+    double gpuClockOffset; // CPU seconds minus GPU seconds
+
+    int dragIndex;   // current or last drag, 0 before the first
+    bool dragging;
+    bool dragOpen;   // current or last drag still has samples to finish
+    size_t dragMoves, dragMissingGpu;
+    RollingHistogram dragStages[StageCount];
+    RollingHistogram allStages[StageCount];
+    std::vector<DragStats> drags;
+};
+
+#endif // LATENCYTRACKER_HPP
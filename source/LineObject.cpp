@@ -0,0 +1,110 @@
+#include "LineObject.hpp"
+#include <glm/gtc/type_ptr.hpp>
+#include "common/shader.hpp"
+#include "UploadStats.hpp"
+
+LineObject::LineObject(const glm::vec3& initColor, float widthPixels)
+    : color(initColor), width(widthPixels), capacity(0), scratchArena(nullptr) {
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &VBO_positions);
+
+    shaderProgram = LoadShaders("lineVertexShader.glsl", "lineFragmentShader.glsl");
+
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO_positions);
+    // Instance i reads vertex i as its start point and vertex i + 1 as its end point.
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0);
+    glVertexAttribDivisor(0, 1);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)sizeof(glm::vec3));
+    glVertexAttribDivisor(1, 1);
+    glEnableVertexAttribArray(1);
+    glBindVertexArray(0);
+}
+
+LineObject::~LineObject() {
+    glDeleteVertexArrays(1, &VAO);
+    glDeleteBuffers(1, &VBO_positions);
+    glDeleteProgram(shaderProgram);
+}
+
+void LineObject::upload(const std::vector<glm::vec3>& polyline, bool closed) {
+    singleRun.clear();
+    PolylineRun run;
+    run.first = 0;
+    run.count = (int)polyline.size();
+    run.closed = closed;
+    singleRun.push_back(run);
+    upload(polyline, singleRun);
+}
+
+void LineObject::upload(const std::vector<glm::vec3>& vertices, const std::vector<PolylineRun>& runs) {
+    if (scratchArena)
+        staging = ArenaVector<glm::vec3>(ArenaAllocator<glm::vec3>(scratchArena)); // the last upload's arena memory may be gone
+    staging.clear();
+    staging.reserve(vertices.size() + runs.size());
+    drawRuns.clear();
+    for (size_t r = 0; r < runs.size(); ++r) {
+        const PolylineRun& run = runs[r];
+        if (run.count < 2)
+            continue;
+        DrawRun drawRun;
+        drawRun.first = (GLint)staging.size();
+        drawRun.segments = run.count - 1 + (run.closed ? 1 : 0);
+        drawRuns.push_back(drawRun);
+        staging.insert(staging.end(), vertices.begin() + run.first, vertices.begin() + run.first + run.count);
+        if (run.closed)
+            staging.push_back(vertices[run.first]);
+    }
+    if (staging.empty())
+        return;
+
+    glBindBuffer(GL_ARRAY_BUFFER, VBO_positions);
+    if (staging.size() > capacity) {
+        capacity = staging.size() + staging.size() / 2;
+        glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(glm::vec3), NULL, GL_DYNAMIC_DRAW);
+    }
+    glBufferSubData(GL_ARRAY_BUFFER, 0, staging.size() * sizeof(glm::vec3), staging.data());
+    UploadStats::add(staging.size() * sizeof(glm::vec3));
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void LineObject::draw(const glm::mat4& view, const glm::mat4& projection) {
+    if (drawRuns.empty())
+        return;
+
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+
+    glUseProgram(shaderProgram);
+    glm::mat4 MVP = projection * view;
+    glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "MVP"), 1, GL_FALSE, glm::value_ptr(MVP));
+    glUniform2f(glGetUniformLocation(shaderProgram, "viewportSize"), (float)viewport[2], (float)viewport[3]);
+    glUniform1f(glGetUniformLocation(shaderProgram, "halfWidth"), 0.5f * width);
+    glUniform3fv(glGetUniformLocation(shaderProgram, "lineColor"), 1, glm::value_ptr(color));
+
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO_positions);
+    for (size_t r = 0; r < drawRuns.size(); ++r) {
+        // GL 3.3 has no base instance, so point the attributes at the run instead.
+        size_t offset = drawRuns[r].first * sizeof(glm::vec3);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)offset);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)(offset + sizeof(glm::vec3)));
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, drawRuns[r].segments);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+    glUseProgram(0);
+}
+
+void LineObject::setColor(const glm::vec3& newColor) {
+    color = newColor;
+}
+
+void LineObject::setWidth(float widthPixels) {
+    width = widthPixels;
+}
+
+void LineObject::setScratchArena(FrameArena* arena) {
+    scratchArena = arena;
+}
@@ -0,0 +1,56 @@
+#ifndef LINEOBJECT_HPP
+#define LINEOBJECT_HPP
+
+#include <vector>
+#include <glm/glm.hpp>
+#include <GL/glew.h>
+#include "FrameArena.hpp"
+#include "Tessellator.hpp"
+
+// Draws a polyline as wide lines on the GPU: one instanced quad per segment,
+// expanded to the requested pixel width in the vertex shader. Both segment
+// end points are read from the same position buffer through two attributes
+// with a divisor of 1, so only one vertex per sample is uploaded. The fragment
+// shader clips each quad to a capsule, which gives round joins and caps.
+class LineObject {
+public:
+    LineObject(const glm::vec3& color, float widthPixels);
+    ~LineObject();
+
+    // Replace the polyline. Closed polylines get a segment back to the first point.
+    void upload(const std::vector<glm::vec3>& polyline, bool closed);
+
+    // Replace with several independent polylines, one per run of vertices.
+    void upload(const std::vector<glm::vec3>& vertices, const std::vector<PolylineRun>& runs);
+
+    void draw(const glm::mat4& view, const glm::mat4& projection);
+
+    void setColor(const glm::vec3& newColor);
+    void setWidth(float widthPixels);
+    // Stage uploads in the arena instead of on the heap. Staging is dead once
+    // upload() returns, so the arena may be reset between calls.
+    void setScratchArena(FrameArena* arena);
+
+private:
+    glm::vec3 color;
+    float width;
+    size_t capacity; // in vertices
+
+    // Runs as laid out in the GPU buffer (closed runs repeat their first vertex).
+    struct DrawRun {
+        GLint first;
+        GLsizei segments;
+    };
+    std::vector<DrawRun> drawRuns;
+    FrameArena* scratchArena;
+    ArenaVector<glm::vec3> staging;
+    std::vector<PolylineRun> singleRun;
+
+    // OpenGL objects.
+    GLuint VAO;
+    GLuint VBO_positions;
+
+    GLuint shaderProgram;
+};
+
+#endif // LINEOBJECT_HPP
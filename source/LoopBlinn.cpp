@@ -0,0 +1,241 @@
+#include "LoopBlinn.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const double kEpsilon = 1e-6;
+
+// Inflection-point polynomial coefficients (Loop & Blinn 2005), scaled so max |d| = 1.
+// Returns false for a straight segment.
+bool computeD(const CubicSegment& s, double& d1, double& d2, double& d3) {
+    glm::dvec3 b0(s.p[0].x, s.p[0].y, 1.0);
+    glm::dvec3 b1(s.p[1].x, s.p[1].y, 1.0);
+    glm::dvec3 b2(s.p[2].x, s.p[2].y, 1.0);
+    glm::dvec3 b3(s.p[3].x, s.p[3].y, 1.0);
+    double a1 = glm::dot(b0, glm::cross(b3, b2));
+    double a2 = glm::dot(b1, glm::cross(b0, b3));
+    double a3 = glm::dot(b2, glm::cross(b1, b0));
+    d1 = a1 - 2.0 * a2 + 3.0 * a3;
+    d2 = -a2 + 3.0 * a3;
+    d3 = 3.0 * a3;
+    double scale = std::max(std::fabs(d1), std::max(std::fabs(d2), std::fabs(d3)));
+    if (scale < 1e-12)
+        return false;
+    d1 /= scale;
+    d2 /= scale;
+    d3 /= scale;
+    return true;
+}
+
+// Parameters where the segment must be split: inflection points, the loop
+// double point and cusps. Only values strictly inside (0, 1) are kept, sorted.
+int splitParameters(const CubicSegment& s, double params[2]) {
+    double d1, d2, d3;
+    if (!computeD(s, d1, d2, d3))
+        return 0;
+    double candidates[2];
+    int count = 0;
+    double disc = 3.0 * d2 * d2 - 4.0 * d1 * d3;
+    if (std::fabs(d1) < kEpsilon) {
+        if (std::fabs(d2) >= kEpsilon)
+            candidates[count++] = d3 / (3.0 * d2);
+    } else if (disc >= 0.0) {
+        double root = std::sqrt(3.0 * disc);
+        candidates[count++] = (3.0 * d2 - root) / (6.0 * d1);
+        candidates[count++] = (3.0 * d2 + root) / (6.0 * d1);
+    } else {
+        double root = std::sqrt(-disc);
+        candidates[count++] = (d2 - root) / (2.0 * d1);
+        candidates[count++] = (d2 + root) / (2.0 * d1);
+    }
+    int kept = 0;
+    for (int i = 0; i < count; ++i)
+        if (candidates[i] > 1e-3 && candidates[i] < 1.0 - 1e-3)
+            params[kept++] = candidates[i];
+    if (kept == 2 && params[1] < params[0])
+        std::swap(params[0], params[1]);
+    return kept;
+}
+
+// Sub-segment over [t0, t1] by two de Casteljau splits.
+CubicSegment subSegment(const CubicSegment& s, double t0, double t1) {
+    glm::dvec3 p[4];
+    for (int i = 0; i < 4; ++i)
+        p[i] = glm::dvec3(s.p[i]);
+    // Keep [t0, 1].
+    if (t0 > 0.0) {
+        glm::dvec3 p01 = glm::mix(p[0], p[1], t0), p12 = glm::mix(p[1], p[2], t0), p23 = glm::mix(p[2], p[3], t0);
+        glm::dvec3 p012 = glm::mix(p01, p12, t0), p123 = glm::mix(p12, p23, t0);
+        p[0] = glm::mix(p012, p123, t0);
+        p[1] = p123;
+        p[2] = p23;
+    }
+    // Keep [0, u] of what is left, u = (t1 - t0) / (1 - t0).
+    double u = t0 < 1.0 ? (t1 - t0) / (1.0 - t0) : 1.0;
+    if (u < 1.0) {
+        glm::dvec3 p01 = glm::mix(p[0], p[1], u), p12 = glm::mix(p[1], p[2], u), p23 = glm::mix(p[2], p[3], u);
+        glm::dvec3 p012 = glm::mix(p01, p12, u), p123 = glm::mix(p12, p23, u);
+        p[1] = p01;
+        p[2] = p012;
+        p[3] = glm::mix(p012, p123, u);
+    }
+    CubicSegment r;
+    for (int i = 0; i < 4; ++i)
+        r.p[i] = glm::vec3(p[i]);
+    return r;
+}
+
+// Bernstein coefficients of the cubic a(t) * b(t) * c(t), each linear factor
+// given by its values at t = 0 and t = 1.
+void product3(const double a[2], const double b[2], const double c[2], double out[4]) {
+    out[0] = a[0] * b[0] * c[0];
+    out[1] = (a[1] * b[0] * c[0] + a[0] * b[1] * c[0] + a[0] * b[0] * c[1]) / 3.0;
+    out[2] = (a[1] * b[1] * c[0] + a[1] * b[0] * c[1] + a[0] * b[1] * c[1]) / 3.0;
+    out[3] = a[1] * b[1] * c[1];
+}
+
+// klm at the four control points of a segment with no interior split points.
+// Returns false when the segment is straight or the klm would be degenerate.
+bool computeKlm(const CubicSegment& s, glm::dvec3 klm[4]) {
+    double d1, d2, d3;
+    if (!computeD(s, d1, d2, d3))
+        return false;
+
+    const double one[2] = { 1.0, 1.0 };
+    double k[4], l[4], m[4];
+    double disc = 3.0 * d2 * d2 - 4.0 * d1 * d3;
+    if (std::fabs(d1) < kEpsilon && std::fabs(d2) < kEpsilon) {
+        // Quadratic: k = m = u, l = v of the elevated quadratic.
+        const double qk[4] = { 0.0, 1.0 / 3.0, 2.0 / 3.0, 1.0 };
+        const double ql[4] = { 0.0, 0.0, 1.0 / 3.0, 1.0 };
+        std::copy(qk, qk + 4, k);
+        std::copy(ql, ql + 4, l);
+        std::copy(qk, qk + 4, m);
+    } else if (std::fabs(d1) < kEpsilon) {
+        // Cusp at infinity: k = L, l = L^3, m = 1.
+        double L[2] = { d3, d3 - 3.0 * d2 };
+        product3(L, one, one, k);
+        product3(L, L, L, l);
+        product3(one, one, one, m);
+    } else if (std::fabs(disc) < kEpsilon) {
+        // Cusp: L == M makes k^3 - l*m vanish everywhere; the caller perturbs and retries.
+        return false;
+    } else if (disc > 0.0) {
+        // Serpentine: k = L*M, l = L^3, m = M^3.
+        double root = std::sqrt(3.0 * disc);
+        double L[2] = { 3.0 * d2 - root, 3.0 * d2 - root - 6.0 * d1 };
+        double M[2] = { 3.0 * d2 + root, 3.0 * d2 + root - 6.0 * d1 };
+        product3(L, M, one, k);
+        product3(L, L, L, l);
+        product3(M, M, M, m);
+    } else {
+        // Loop: k = L*M, l = L^2*M, m = L*M^2.
+        double root = std::sqrt(-disc);
+        double L[2] = { d2 - root, d2 - root - 2.0 * d1 };
+        double M[2] = { d2 + root, d2 + root - 2.0 * d1 };
+        product3(L, M, one, k);
+        product3(L, L, M, l);
+        product3(L, M, M, m);
+    }
+    for (int i = 0; i < 4; ++i)
+        klm[i] = glm::dvec3(k[i], l[i], m[i]);
+    return true;
+}
+
+double cross2(const glm::dvec2& a, const glm::dvec2& b) {
+    return a.x * b.y - a.y * b.x;
+}
+
+// klm varies affinely over the plane; evaluate it at q through the largest
+// triangle of control points.
+bool interpolateKlm(const CubicSegment& s, const glm::dvec3 klm[4], const glm::dvec2& q, glm::dvec3& result) {
+    static const int triangles[4][3] = { { 0, 1, 2 }, { 0, 1, 3 }, { 0, 2, 3 }, { 1, 2, 3 } };
+    int best = -1;
+    double bestArea = 0.0;
+    for (int t = 0; t < 4; ++t) {
+        glm::dvec2 a(s.p[triangles[t][0]]), b(s.p[triangles[t][1]]), c(s.p[triangles[t][2]]);
+        double area = std::fabs(cross2(b - a, c - a));
+        if (area > bestArea) {
+            bestArea = area;
+            best = t;
+        }
+    }
+    if (best < 0 || bestArea < 1e-12)
+        return false;
+
+    const int* tri = triangles[best];
+    glm::dvec2 a(s.p[tri[0]]), b(s.p[tri[1]]), c(s.p[tri[2]]);
+    double area = cross2(b - a, c - a);
+    double wb = cross2(q - a, c - a) / area;
+    double wc = cross2(b - a, q - a) / area;
+    double wa = 1.0 - wb - wc;
+    result = wa * klm[tri[0]] + wb * klm[tri[1]] + wc * klm[tri[2]];
+    return true;
+}
+
+void appendPiece(CubicSegment piece, std::vector<CurveFillVertex>& out) {
+    glm::dvec3 klm[4];
+    bool ok = computeKlm(piece, klm);
+    for (int attempt = 0; !ok && attempt < 3; ++attempt) {
+        // Cusp: nudge the handles off the degenerate configuration.
+        double d1, d2, d3;
+        if (!computeD(piece, d1, d2, d3))
+            return;
+        float nudge = 1e-4f * glm::length(piece.p[3] - piece.p[0]) + 1e-6f;
+        piece.p[1] += glm::vec3(nudge, -nudge, 0.0f);
+        piece.p[2] += glm::vec3(-nudge, nudge, 0.0f);
+        ok = computeKlm(piece, klm);
+    }
+    if (!ok)
+        return;
+
+    // Orient so the lobe between chord and curve is negative.
+    glm::dvec2 q = 0.25 * glm::dvec2(piece.p[0] + piece.p[3]) + 0.5 * glm::dvec2(evaluateSegment(piece, 0.5f));
+    glm::dvec3 atQ;
+    if (!interpolateKlm(piece, klm, q, atQ))
+        return;
+    if (atQ.x * atQ.x * atQ.x - atQ.y * atQ.z > 0.0) {
+        for (int i = 0; i < 4; ++i) {
+            klm[i].x = -klm[i].x;
+            klm[i].y = -klm[i].y;
+        }
+    }
+
+    static const int order[6] = { 0, 1, 2, 0, 2, 3 };
+    for (int i = 0; i < 6; ++i) {
+        CurveFillVertex v;
+        v.position = piece.p[order[i]];
+        v.klm = glm::vec3(klm[order[i]]);
+        out.push_back(v);
+    }
+}
+
+} // namespace
+
+void appendCubicHull(const CubicSegment& segment, std::vector<CurveFillVertex>& out) {
+    size_t start = out.size();
+
+    double params[4] = { 0.0 };
+    int count = 1 + splitParameters(segment, params + 1);
+    params[count++] = 1.0;
+
+    for (int i = 0; i + 1 < count; ++i)
+        appendPiece(subSegment(segment, params[i], params[i + 1]), out);
+
+    // Pad with degenerate triangles to the fixed per-segment size.
+    CurveFillVertex pad;
+    pad.position = segment.p[0];
+    pad.klm = glm::vec3(0.0f);
+    while (out.size() < start + kHullVerticesPerSegment)
+        out.push_back(pad);
+}
+
+void appendQuadraticHull(const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2, std::vector<CurveFillVertex>& out) {
+    CubicSegment s;
+    s.p[0] = p0;
+    s.p[1] = p0 + (2.0f / 3.0f) * (p1 - p0);
+    s.p[2] = p2 + (2.0f / 3.0f) * (p1 - p2);
+    s.p[3] = p2;
+    appendCubicHull(s, out);
+}
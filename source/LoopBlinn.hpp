@@ -0,0 +1,30 @@
+#ifndef LOOPBLINN_HPP
+#define LOOPBLINN_HPP
+
+#include <vector>
+#include <glm/glm.hpp>
+#include "Tessellator.hpp"
+
+// Vertex of a curve hull triangle. klm are the Loop-Blinn implicit coordinates:
+// the curve is k^3 - l*m = 0 and the region between the chord and the curve is
+// where k^3 - l*m < 0 (see curveFillFragmentShader.glsl).
+struct CurveFillVertex {
+    glm::vec3 position;
+    glm::vec3 klm;
+};
+
+// Every segment produces exactly this many vertices (unused triangles are
+// degenerate), so a segment's hull always occupies the same slice of a buffer.
+// A cubic is split into at most three pieces at its inflection points and loop
+// double point, each piece gets two triangles.
+const int kHullVerticesPerSegment = 18;
+
+// Appends the hull triangles covering the region between the segment's chord
+// (p[0] to p[3]) and the curve. Triangles wind the same way as the closed
+// contour curve-then-chord, so facing gives the winding sign for stencil fills.
+void appendCubicHull(const CubicSegment& segment, std::vector<CurveFillVertex>& out);
+
+// Quadratic with control points p0, p1, p2, via degree elevation.
+void appendQuadraticHull(const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2, std::vector<CurveFillVertex>& out);
+
+#endif // LOOPBLINN_HPP
@@ -0,0 +1,55 @@
+#include "ParallelTessellator.hpp"
+
+ParallelTessellator::ParallelTessellator() : grain(64) {
+}
+
+void ParallelTessellator::setGrain(size_t curves) {
+    grain = curves < 1 ? 1 : curves;
+}
+
+void ParallelTessellator::tessellate(JobSystem& jobs, const std::vector<std::vector<glm::vec3> >& curves, int steps, bool closed,
+                                     std::vector<glm::vec3>& out, std::vector<PolylineRun>& runs) {
+    size_t curveCount = curves.size();
+    size_t chunks = (curveCount + grain - 1) / grain;
+    chunkOffsets.assign(chunks + 1, 0);
+    runs.resize(curveCount);
+    segmentScratch.resize(jobs.threadCount());
+
+    // Pass 1: vertex count of every curve, summed per chunk.
+    jobs.parallelFor(chunks, 1, [&](size_t begin, size_t end) {
+        for (size_t chunk = begin; chunk < end; ++chunk) {
+            size_t total = 0;
+            size_t last = glm::min((chunk + 1) * grain, curveCount);
+            for (size_t c = chunk * grain; c < last; ++c)
+                total += tessellatedCurveSize(curves[c].size(), steps, closed);
+            chunkOffsets[chunk + 1] = total;
+        }
+    });
+
+    // Exclusive prefix sum over the chunk totals.
+    for (size_t chunk = 0; chunk < chunks; ++chunk)
+        chunkOffsets[chunk + 1] += chunkOffsets[chunk];
+    out.resize(chunkOffsets[chunks]);
+
+    // Pass 2: every chunk writes its curves from its own offset on.
+    jobs.parallelFor(chunks, 1, [&](size_t begin, size_t end) {
+        std::vector<CubicSegment>& segments = segmentScratch[jobs.currentThreadIndex()];
+        for (size_t chunk = begin; chunk < end; ++chunk) {
+            glm::vec3* write = out.data() + chunkOffsets[chunk];
+            size_t last = glm::min((chunk + 1) * grain, curveCount);
+            for (size_t c = chunk * grain; c < last; ++c) {
+                size_t count = tessellatedCurveSize(curves[c].size(), steps, closed);
+                PolylineRun& run = runs[c];
+                run.first = (int)(write - out.data());
+                run.count = (int)count;
+                run.closed = closed && count > 1;
+                if (count == 0)
+                    continue;
+                buildClosedCurve(curves[c], segments);
+                // A closed curve ends where it started; that last sample is left out.
+                for (size_t i = 0; i < segments.size(); ++i)
+                    write = tessellateSegment(segments[i], steps, i > 0, closed && i + 1 == segments.size(), write);
+            }
+        }
+    });
+}
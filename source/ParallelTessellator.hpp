@@ -0,0 +1,32 @@
+#ifndef PARALLELTESSELLATOR_HPP
+#define PARALLELTESSELLATOR_HPP
+
+#include <vector>
+#include <glm/glm.hpp>
+#include "JobSystem.hpp"
+#include "Tessellator.hpp"
+
+// Tessellates many curves at once on a job system. The curve list is split
+// into chunks; each chunk first sums the vertex counts of its curves, a
+// prefix sum over the chunk totals gives every chunk its output offset, and
+// the chunks then write their samples straight into one contiguous buffer.
+// Every sample comes from the same arithmetic as the serial path and lands at
+// the same place, so the output is bit-identical to tessellateCurves()
+// whatever the thread count or chunking. Scratch is kept between calls.
+class ParallelTessellator {
+public:
+    ParallelTessellator();
+
+    // Curves per chunk.
+    void setGrain(size_t curves);
+
+    void tessellate(JobSystem& jobs, const std::vector<std::vector<glm::vec3> >& curves, int steps, bool closed,
+                    std::vector<glm::vec3>& out, std::vector<PolylineRun>& runs);
+
+private:
+    size_t grain;
+    std::vector<size_t> chunkOffsets;
+    std::vector<std::vector<CubicSegment> > segmentScratch; // one per thread
+};
+
+#endif // PARALLELTESSELLATOR_HPP
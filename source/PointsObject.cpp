@@ -1,20 +1,25 @@
 #include "PointsObject.hpp"
 #include <glm/gtc/type_ptr.hpp>
+#include <algorithm>
 #include <iostream>
 #include "common/shader.hpp"
+#include "Trace.hpp"
+#include "UploadStats.hpp"
 
-PointsObject::PointsObject(const std::vector<glm::vec3>& initPositions, const std::vector<glm::vec3>& initColors) {
+PointsObject::PointsObject(const std::vector<glm::vec3>& initPositions, const std::vector<glm::vec3>& initColors,
+                           PositionFormat initPositionFormat, double initTileSize)
+    : positionFormat(initPositionFormat), format(pointVertexFormat(initPositionFormat)), tileSize(initTileSize), EBO_tiles(0) {
     if (initPositions.size() != initColors.size()) {
         //std::cerr << "Error: positions and colors vectors must have the same size." << std::endl;
         return;
     }
-    positions = initPositions;
-    colors = initColors;
+    TRACE_SCOPE("PointsObject upload");
+    for (size_t i = 0; i < initPositions.size(); ++i)
+        points.push(initPositions[i], initColors[i]);
 
-    // Generate VAO and two VBOs (one for positions, one for colors)
+    // Generate the VAO and one VBO of interleaved vertices
     glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO_positions);
-    glGenBuffers(1, &VBO_colors);
+    glGenBuffers(1, &VBO_vertices);
 
     // Load the shader programs.
     shaderProgram = LoadShaders("pointVertexShader.glsl", "pointFragmentShader.glsl");
@@ -22,40 +27,77 @@ PointsObject::PointsObject(const std::vector<glm::vec3>& initPositions, const st
 
     glBindVertexArray(VAO); // bind VAO to set up the vertex attributes
 
-    glBindBuffer(GL_ARRAY_BUFFER, VBO_positions);
-    glBufferData(GL_ARRAY_BUFFER, positions.size() * sizeof(glm::vec3), positions.data(), GL_DYNAMIC_DRAW);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
-    glEnableVertexAttribArray(0);
-
-    glBindBuffer(GL_ARRAY_BUFFER, VBO_colors);
-    glBufferData(GL_ARRAY_BUFFER, colors.size() * sizeof(glm::vec3), colors.data(), GL_DYNAMIC_DRAW);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
-    glEnableVertexAttribArray(1);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO_vertices);
+    glBufferData(GL_ARRAY_BUFFER, bufferBytes(), NULL, GL_DYNAMIC_DRAW);
+    format.apply();
+    if (positionFormat == PositionFormat::Quantized16) {
+        glGenBuffers(1, &EBO_tiles);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO_tiles); // part of the VAO state
+        buildTiles();
+    }
+    uploadVertices(0, points.size());
 
     glBindVertexArray(0); // Unbind VAO after attributes are set
 }
 
 PointsObject::~PointsObject() {
     glDeleteVertexArrays(1, &VAO);
-    glDeleteBuffers(1, &VBO_positions);
-    glDeleteBuffers(1, &VBO_colors);
+    glDeleteBuffers(1, &VBO_vertices);
+    if (EBO_tiles)
+        glDeleteBuffers(1, &EBO_tiles);
     glDeleteProgram(shaderProgram);
     glDeleteProgram(pickingShaderProgram);
 }
 
+// Packs the points straight from the store's streams, a page at a time, and
+// uploads them in one call. VBO_vertices must be bound.
+void PointsObject::uploadVertices(size_t first, size_t count) {
+    if (count == 0)
+        return;
+    staging.resize(count * format.stride);
+    size_t end = first + count;
+    for (size_t page = ControlPointStore::pageOf(first); page * ControlPointStore::kPageSize < end; ++page) {
+        size_t pageStart = page * ControlPointStore::kPageSize;
+        size_t stop = std::min(end, pageStart + points.pagePoints(page));
+        const float* x = points.stream(page, ControlPointStore::X);
+        const float* y = points.stream(page, ControlPointStore::Y);
+        const float* z = points.stream(page, ControlPointStore::Z);
+        const float* r = points.stream(page, ControlPointStore::R);
+        const float* g = points.stream(page, ControlPointStore::G);
+        const float* b = points.stream(page, ControlPointStore::B);
+        for (size_t i = std::max(first, pageStart); i < stop; ++i) {
+            size_t lane = i - pageStart;
+            glm::vec3 position(x[lane], y[lane], z[lane]);
+            glm::vec3 color(r[lane], g[lane], b[lane]);
+            unsigned char* out = &staging[(i - first) * format.stride];
+            if (positionFormat == PositionFormat::Quantized16)
+                packPointVertex(positionFormat, position, color, out, tiles[pointTiles[i]].origin, tileSize);
+            else
+                packPointVertex(positionFormat, position, color, out);
+        }
+    }
+    glBufferSubData(GL_ARRAY_BUFFER, first * format.stride, staging.size(), staging.data());
+    UploadStats::add(staging.size());
+}
+
 void PointsObject::updatePoint(int index, const glm::vec3& newPosition) {
-    if (index < 0 || index >= positions.size()) {
+    if (index < 0 || index >= (int)points.size()) {
         //std::cerr << "Error: point index out of range." << std::endl;
         return;
     }
     
-    positions[index] = newPosition;
+    TRACE_SCOPE("PointsObject updatePoint");
+    points.setPosition(index, newPosition);
+    if (positionFormat == PositionFormat::Quantized16 && tileOriginOf(newPosition, tileSize) != tiles[pointTiles[index]].origin) {
+        glBindVertexArray(VAO); // the index buffer binding lives in the VAO
+        buildTiles();
+        glBindVertexArray(0);
+    }
     
-    glBindBuffer(GL_ARRAY_BUFFER, VBO_positions);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO_vertices);
     
     //TODO: P2aTask3 - Use glBufferSubData to updated the point location in the buffer.
-    int Offset = index * sizeof(glm::vec3), size = sizeof(glm::vec3);
-    glBufferSubData(GL_ARRAY_BUFFER, Offset, size, &positions[index]);
+    uploadVertices(index, 1); // the whole vertex: its color is only four bytes
     
     glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
@@ -63,40 +105,97 @@ void PointsObject::updatePoint(int index, const glm::vec3& newPosition) {
 
 // Draw the points normally.
 void PointsObject::draw(const glm::mat4& view, const glm::mat4& projection) {
+    TRACE_SCOPE("PointsObject draw");
     glUseProgram(shaderProgram);
+    if (positionFormat == PositionFormat::Quantized16) {
+        drawTiles(shaderProgram, view, projection);
+        return;
+    }
     glm::mat4 MVP = projection * view;
     GLuint mvpLoc = glGetUniformLocation(shaderProgram, "MVP");
     glUniformMatrix4fv(mvpLoc, 1, GL_FALSE, glm::value_ptr(MVP));
 
     glBindVertexArray(VAO);
-    glDrawArrays(GL_POINTS, 0, positions.size());
+    glDrawArrays(GL_POINTS, 0, (GLsizei)points.size());
     glBindVertexArray(0);
     glUseProgram(0);
 }
 
 // Draw the points for picking.
 void PointsObject::drawPicking(const glm::mat4& view, const glm::mat4& projection) {
+    TRACE_SCOPE("PointsObject drawPicking");
     glUseProgram(pickingShaderProgram);
+    if (positionFormat == PositionFormat::Quantized16) {
+        drawTiles(pickingShaderProgram, view, projection);
+        return;
+    }
     glm::mat4 MVP = projection * view;
     GLuint mvpLoc = glGetUniformLocation(pickingShaderProgram, "MVP");
     glUniformMatrix4fv(mvpLoc, 1, GL_FALSE, glm::value_ptr(MVP));
 
     glBindVertexArray(VAO);
     // In the picking shader, we rely on gl_VertexID to generate a unique color per point.
-    glDrawArrays(GL_POINTS, 0, positions.size());
+    glDrawArrays(GL_POINTS, 0, (GLsizei)points.size());
+    glBindVertexArray(0);
+    glUseProgram(0);
+}
+
+// One draw per tile. Indexed drawing sets gl_VertexID to the index, so picking
+// still sees the point index. Leaves the program unbound.
+void PointsObject::drawTiles(GLuint program, const glm::mat4& view, const glm::mat4& projection) {
+    GLuint mvpLoc = glGetUniformLocation(program, "MVP");
+    glBindVertexArray(VAO);
+    for (size_t t = 0; t < tiles.size(); ++t) {
+        glm::mat4 MVP = tileMatrix(projection, view, tiles[t].origin, tileSize);
+        glUniformMatrix4fv(mvpLoc, 1, GL_FALSE, glm::value_ptr(MVP));
+        glDrawElements(GL_POINTS, tiles[t].count, GL_UNSIGNED_INT, (void*)(tiles[t].first * sizeof(GLuint)));
+    }
     glBindVertexArray(0);
     glUseProgram(0);
 }
 
+// Tiles are keyed by their origin; points sort by it, lexicographically, then by index.
+void PointsObject::buildTiles() {
+    size_t n = points.size();
+    tileIndices.resize(n);
+    for (size_t i = 0; i < n; ++i)
+        tileIndices[i] = (GLuint)i;
+    auto originLess = [](const glm::dvec2& a, const glm::dvec2& b) {
+        return a.x < b.x || (a.x == b.x && a.y < b.y);
+    };
+    std::sort(tileIndices.begin(), tileIndices.end(), [&](GLuint a, GLuint b) {
+        glm::dvec2 ta = tileOriginOf(points.position(a), tileSize), tb = tileOriginOf(points.position(b), tileSize);
+        return originLess(ta, tb) || (ta == tb && a < b);
+    });
+
+    tiles.clear();
+    pointTiles.resize(n);
+    for (size_t k = 0; k < n; ++k) {
+        glm::dvec2 origin = tileOriginOf(points.position(tileIndices[k]), tileSize);
+        if (tiles.empty() || tiles.back().origin != origin) {
+            Tile tile;
+            tile.origin = origin;
+            tile.first = (GLsizei)k;
+            tile.count = 0;
+            tiles.push_back(tile);
+        }
+        tiles.back().count++;
+        pointTiles[tileIndices[k]] = (int)tiles.size() - 1;
+    }
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, n * sizeof(GLuint), tileIndices.data(), GL_DYNAMIC_DRAW);
+    UploadStats::add(n * sizeof(GLuint));
+}
+
 glm::vec3 PointsObject::getPointColor(int index) {
-    return colors[index];
+    return points.color(index);
 }
 
-void PointsObject::setPointColor(int index, glm::vec3 &newColor) {
+void PointsObject::setPointColor(int index, const glm::vec3& newColor) {
     std::cout << "Setting color for point " << index << " to " << newColor.r << ", " << newColor.g << ", " << newColor.b << std::endl;
-    colors[index] = newColor;
+    TRACE_SCOPE("PointsObject setPointColor");
+    points.setColor(index, newColor);
 
-    glBindBuffer(GL_ARRAY_BUFFER, VBO_colors);
-    glBufferSubData(GL_ARRAY_BUFFER, index * sizeof(glm::vec3), sizeof(glm::vec3), &colors[index]);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO_vertices);
+    uploadVertices(index, 1);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
\ No newline at end of file
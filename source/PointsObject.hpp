@@ -4,11 +4,20 @@
 #include <vector>
 #include <glm/glm.hpp>
 #include <GL/glew.h>
+#include "ControlPointStore.hpp"
+#include "VertexFormat.hpp"
 
+// Control points drawn as round sprites. The points live in a
+// ControlPointStore; the GPU gets them packed and interleaved in the
+// pointVertexFormat() layout, float or half positions with RGBA8 colors.
+// Quantized16 points are grouped into tiles, each drawn with its own
+// tileMatrix() through a per-tile index list; the indices keep gl_VertexID
+// equal to the point index, which picking relies on.
 class PointsObject {
 public:
     // Constructor takes two vectors (positions and colors) of equal length.
-    PointsObject(const std::vector<glm::vec3>& positions, const std::vector<glm::vec3>& colors);
+    PointsObject(const std::vector<glm::vec3>& positions, const std::vector<glm::vec3>& colors,
+                 PositionFormat positionFormat = PositionFormat::Float, double tileSize = 1.0);
     ~PointsObject();
 
     // Update the position of the point at the given index.
@@ -20,19 +29,40 @@ public:
     // Draw the points for picking (using a picking shader).
     void drawPicking(const glm::mat4& view, const glm::mat4& projection);
 
-    void setPointColor(int index, glm::vec3 &newColor);
+    void setPointColor(int index, const glm::vec3& newColor);
 
     glm::vec3 getPointColor(int index);
 
+    // Size of the vertex buffer.
+    size_t bufferBytes() const { return points.size() * format.stride; }
+
 private:
-    // Storage for positions and colors.
-    std::vector<glm::vec3> positions;
-    std::vector<glm::vec3> colors;
+    struct Tile {
+        glm::dvec2 origin;
+        GLsizei first; // into tileIndices
+        GLsizei count;
+    };
+
+    void uploadVertices(size_t first, size_t count);
+    // Quantized16: sorts the points into tiles and uploads the index lists.
+    void buildTiles();
+    void drawTiles(GLuint program, const glm::mat4& view, const glm::mat4& projection);
+
+    ControlPointStore points;
+    PositionFormat positionFormat;
+    VertexFormat format;
+    std::vector<unsigned char> staging; // packed vertices on their way to the buffer
+
+    // Quantized16 only.
+    double tileSize;
+    std::vector<Tile> tiles;           // sorted by origin
+    std::vector<int> pointTiles;       // tile of every point
+    std::vector<GLuint> tileIndices;   // point indices, grouped by tile
 
     // OpenGL objects.
     GLuint VAO;
-    GLuint VBO_positions;
-    GLuint VBO_colors;
+    GLuint VBO_vertices;
+    GLuint EBO_tiles;
 
     // Shader programs.
     GLuint shaderProgram;
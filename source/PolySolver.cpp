@@ -0,0 +1,234 @@
+#include "PolySolver.hpp"
+#include <cmath>
+#include <limits>
+#include "Simd.hpp"
+
+namespace {
+
+const float kNaN = std::numeric_limits<float>::quiet_NaN();
+const float kDegenerate = 1e-6f;     // |leading| / max|other| below this -> lower degree
+const float kIllConditioned = 1e-4f; // |discriminant| relative to its terms below this -> flag
+
+// acos on [-1, 1], Abramowitz & Stegun 4.4.46 (|error| < 2e-8 on [0, 1]).
+Float4 acosApprox(Float4 x) {
+    Float4 ax = min(abs(x), Float4(1.0f));
+    Float4 p = Float4(-0.0012624911f);
+    p = madd(p, ax, Float4(0.0066700901f));
+    p = madd(p, ax, Float4(-0.0170881256f));
+    p = madd(p, ax, Float4(0.0308918810f));
+    p = madd(p, ax, Float4(-0.0501743046f));
+    p = madd(p, ax, Float4(0.0889789874f));
+    p = madd(p, ax, Float4(-0.2145988016f));
+    p = madd(p, ax, Float4(1.5707963050f));
+    Float4 r = sqrt(Float4(1.0f) - ax) * p;
+    return select(x < Float4(0.0f), Float4(3.14159265f) - r, r);
+}
+
+// cos and sin on [0, pi/3] by truncated Taylor series (error < 5e-8).
+void cosSinSmall(Float4 x, Float4& c, Float4& s) {
+    Float4 x2 = x * x;
+    c = madd(x2, Float4(-1.0f / 3628800.0f), Float4(1.0f / 40320.0f));
+    c = madd(c, x2, Float4(-1.0f / 720.0f));
+    c = madd(c, x2, Float4(1.0f / 24.0f));
+    c = madd(c, x2, Float4(-0.5f));
+    c = madd(c, x2, Float4(1.0f));
+    s = madd(x2, Float4(1.0f / 362880.0f), Float4(-1.0f / 5040.0f));
+    s = madd(s, x2, Float4(1.0f / 120.0f));
+    s = madd(s, x2, Float4(-1.0f / 6.0f));
+    s = madd(s, x2, Float4(1.0f));
+    s = s * x;
+}
+
+// One Newton step on a*t^2 + b*t + c, kept only where it does not increase |f|.
+Float4 polishQuadratic(Float4 a, Float4 b, Float4 c, Float4 t) {
+    Float4 f = madd(madd(a, t, b), t, c);
+    Float4 fp = madd(a + a, t, b);
+    Float4 tn = t - f / fp;
+    Float4 fn = madd(madd(a, tn, b), tn, c);
+    return select(abs(fn) <= abs(f), tn, t);
+}
+
+// Same for the monic cubic t^3 + b*t^2 + c*t + d.
+Float4 polishCubic(Float4 b, Float4 c, Float4 d, Float4 t) {
+    Float4 f = madd(madd(t + b, t, c), t, d);
+    Float4 fp = madd(madd(Float4(3.0f), t, b + b), t, c);
+    Float4 tn = t - f / fp;
+    Float4 fn = madd(madd(tn + b, tn, c), tn, d);
+    return select(abs(fn) <= abs(f), tn, t);
+}
+
+void quadraticBlock(const float* pa, const float* pb, const float* pc,
+                    float* out0, float* out1, uint8_t* counts, uint8_t* flags) {
+    Float4 a = Float4::load(pa), b = Float4::load(pb), c = Float4::load(pc);
+
+    Float4 disc = b * b - Float4(4.0f) * a * c;
+    Mask4 real = disc >= Float4(0.0f);
+    Float4 q = Float4(-0.5f) * (b + signOf(b) * sqrt(max(disc, Float4(0.0f))));
+    // q == 0 only when b == 0 and disc == 0, i.e. c == 0: a double root at 0.
+    Mask4 qZero = abs(q) <= Float4(0.0f);
+    Float4 r1 = select(qZero, Float4(0.0f), q / a);
+    Float4 r2 = select(qZero, Float4(0.0f), c / q);
+    Float4 lo = polishQuadratic(a, b, c, min(r1, r2));
+    Float4 hi = polishQuadratic(a, b, c, max(r1, r2));
+
+    select(real, lo, Float4(kNaN)).store(out0);
+    select(real, hi, Float4(kNaN)).store(out1);
+
+    int degenerate = bits(abs(a) <= Float4(kDegenerate) * max(abs(b), abs(c)));
+    int ill = bits(real & (abs(disc) <= Float4(kIllConditioned) * (b * b + abs(Float4(4.0f) * a * c))));
+    int realBits = bits(real);
+    for (int i = 0; i < 4; ++i) {
+        if (degenerate & (1 << i)) {
+            // Linear (or constant) equation.
+            out1[i] = kNaN;
+            if (pb[i] != 0.0f) {
+                out0[i] = -pc[i] / pb[i];
+                counts[i] = 1;
+            } else {
+                out0[i] = kNaN;
+                counts[i] = 0;
+            }
+            if (flags) flags[i] = ROOTS_DEGENERATE;
+            continue;
+        }
+        counts[i] = (realBits & (1 << i)) ? 2 : 0;
+        if (flags) flags[i] = (ill & (1 << i)) ? ROOTS_ILL_CONDITIONED : ROOTS_OK;
+    }
+}
+
+void cubicBlock(const float* pa, const float* pb, const float* pc, const float* pd,
+                float* out0, float* out1, float* out2, uint8_t* counts, uint8_t* flags) {
+    Float4 a = Float4::load(pa);
+    // Monic form t^3 + B t^2 + C t + D, then depressed form x^3 + p x + q with t = x - B/3.
+    Float4 B = Float4::load(pb) / a, C = Float4::load(pc) / a, D = Float4::load(pd) / a;
+    Float4 shift = B * Float4(-1.0f / 3.0f);
+    Float4 p3 = (C - B * B * Float4(1.0f / 3.0f)) * Float4(1.0f / 3.0f);
+    Float4 q2 = (B * B * B * Float4(2.0f / 27.0f) - B * C * Float4(1.0f / 3.0f) + D) * Float4(0.5f);
+    Float4 pCubed = p3 * p3 * p3;
+    Float4 disc = q2 * q2 + pCubed;
+    Mask4 three = disc <= Float4(0.0f);
+
+    // One real root (Cardano), written so the two cube-root terms never cancel.
+    Float4 u = -signOf(q2) * cbrt(abs(q2) + sqrt(max(disc, Float4(0.0f))));
+    Float4 single = select(abs(u) > Float4(0.0f), u - p3 / u, Float4(0.0f));
+
+    // Three real roots (trigonometric form); roots come out already ordered.
+    Float4 r = sqrt(max(-p3, Float4(0.0f)));
+    Float4 arg = select(r > Float4(0.0f), -q2 / (r * r * r), Float4(0.0f));
+    Float4 phi = acosApprox(max(min(arg, Float4(1.0f)), Float4(-1.0f))) * Float4(1.0f / 3.0f);
+    Float4 cs, sn;
+    cosSinSmall(phi, cs, sn);
+    Float4 twoR = r + r;
+    Float4 hiRoot = twoR * cs;
+    Float4 midRoot = twoR * (Float4(-0.5f) * cs + Float4(0.8660254f) * sn);
+    Float4 loRoot = twoR * (Float4(-0.5f) * cs - Float4(0.8660254f) * sn);
+
+    Float4 t0 = select(three, loRoot, single) + shift;
+    Float4 t1 = select(three, midRoot + shift, Float4(kNaN));
+    Float4 t2 = select(three, hiRoot + shift, Float4(kNaN));
+
+    // The approximations above are only good to ~1e-7 relative; Newton restores full precision.
+    for (int it = 0; it < 2; ++it) {
+        t0 = polishCubic(B, C, D, t0);
+        t1 = polishCubic(B, C, D, t1);
+        t2 = polishCubic(B, C, D, t2);
+    }
+    // Polishing can swap nearly equal roots; re-sort the three-root lanes.
+    Float4 s0 = min(t0, t1), s1 = max(t0, t1);
+    Float4 s2 = max(s1, t2);
+    s1 = min(s1, t2);
+    Float4 f0 = min(s0, s1), f1 = max(s0, s1);
+    select(three, f0, t0).store(out0);
+    select(three, f1, t1).store(out1);
+    select(three, s2, t2).store(out2);
+
+    Float4 absA = abs(a);
+    Float4 scale = max(max(abs(Float4::load(pb)), abs(Float4::load(pc))), abs(Float4::load(pd)));
+    int degenerate = bits(absA <= Float4(kDegenerate) * scale);
+    int ill = bits(abs(disc) <= Float4(kIllConditioned) * (q2 * q2 + abs(pCubed)));
+    int threeBits = bits(three);
+    for (int i = 0; i < 4; ++i) {
+        if (degenerate & (1 << i)) {
+            float qr[2];
+            counts[i] = (uint8_t)solveQuadratic(pb[i], pc[i], pd[i], qr);
+            out0[i] = counts[i] > 0 ? qr[0] : kNaN;
+            out1[i] = counts[i] > 1 ? qr[1] : kNaN;
+            out2[i] = kNaN;
+            if (flags) flags[i] = ROOTS_DEGENERATE;
+            continue;
+        }
+        counts[i] = (threeBits & (1 << i)) ? 3 : 1;
+        if (flags) flags[i] = (ill & (1 << i)) ? ROOTS_ILL_CONDITIONED : ROOTS_OK;
+    }
+}
+
+} // namespace
+
+void solveQuadratics(const float* a, const float* b, const float* c, size_t n,
+                     float* roots, uint8_t* counts, uint8_t* flags) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+        quadraticBlock(a + i, b + i, c + i, roots + i, roots + n + i, counts + i, flags ? flags + i : nullptr);
+    if (i == n) return;
+
+    // Tail: pad to a full block with a harmless equation (t^2 - 1 = 0).
+    float ta[4] = { 1, 1, 1, 1 }, tb[4] = { 0, 0, 0, 0 }, tc[4] = { -1, -1, -1, -1 };
+    float o0[4], o1[4];
+    uint8_t tCounts[4], tFlags[4];
+    size_t rest = n - i;
+    for (size_t k = 0; k < rest; ++k) {
+        ta[k] = a[i + k]; tb[k] = b[i + k]; tc[k] = c[i + k];
+    }
+    quadraticBlock(ta, tb, tc, o0, o1, tCounts, tFlags);
+    for (size_t k = 0; k < rest; ++k) {
+        roots[i + k] = o0[k];
+        roots[n + i + k] = o1[k];
+        counts[i + k] = tCounts[k];
+        if (flags) flags[i + k] = tFlags[k];
+    }
+}
+
+void solveCubics(const float* a, const float* b, const float* c, const float* d, size_t n,
+                 float* roots, uint8_t* counts, uint8_t* flags) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+        cubicBlock(a + i, b + i, c + i, d + i, roots + i, roots + n + i, roots + 2 * n + i,
+                   counts + i, flags ? flags + i : nullptr);
+    if (i == n) return;
+
+    // Tail: pad with t^3 - t = 0.
+    float ta[4] = { 1, 1, 1, 1 }, tb[4] = { 0, 0, 0, 0 }, tc[4] = { -1, -1, -1, -1 }, td[4] = { 0, 0, 0, 0 };
+    float o0[4], o1[4], o2[4];
+    uint8_t tCounts[4], tFlags[4];
+    size_t rest = n - i;
+    for (size_t k = 0; k < rest; ++k) {
+        ta[k] = a[i + k]; tb[k] = b[i + k]; tc[k] = c[i + k]; td[k] = d[i + k];
+    }
+    cubicBlock(ta, tb, tc, td, o0, o1, o2, tCounts, tFlags);
+    for (size_t k = 0; k < rest; ++k) {
+        roots[i + k] = o0[k];
+        roots[n + i + k] = o1[k];
+        roots[2 * n + i + k] = o2[k];
+        counts[i + k] = tCounts[k];
+        if (flags) flags[i + k] = tFlags[k];
+    }
+}
+
+int solveQuadratic(float a, float b, float c, float roots[2]) {
+    float r[2];
+    uint8_t count;
+    solveQuadratics(&a, &b, &c, 1, r, &count, nullptr);
+    roots[0] = r[0];
+    roots[1] = r[1];
+    return count;
+}
+
+int solveCubic(float a, float b, float c, float d, float roots[3]) {
+    float r[3];
+    uint8_t count;
+    solveCubics(&a, &b, &c, &d, 1, r, &count, nullptr);
+    roots[0] = r[0];
+    roots[1] = r[1];
+    roots[2] = r[2];
+    return count;
+}
@@ -0,0 +1,33 @@
+#ifndef POLYSOLVER_HPP
+#define POLYSOLVER_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+// Per-equation flags written by the batch solvers.
+enum RootFlags : uint8_t {
+    ROOTS_OK = 0,
+    ROOTS_DEGENERATE = 1,       // leading coefficient ~0, solved as a lower degree
+    ROOTS_ILL_CONDITIONED = 2   // discriminant ~0 (near-multiple roots), expect reduced accuracy
+};
+
+// Batch solvers for n equations in structure-of-arrays form: coefficient k of
+// equation i is coeff_k[i]. Real roots of equation i are written to
+// roots[j * n + i] for j < counts[i], sorted ascending; unused slots are NaN.
+// flags may be null.
+
+// a*t^2 + b*t + c = 0, roots holds 2*n floats.
+void solveQuadratics(const float* a, const float* b, const float* c, size_t n,
+                     float* roots, uint8_t* counts, uint8_t* flags);
+
+// a*t^3 + b*t^2 + c*t + d = 0, roots holds 3*n floats.
+// Three real roots are reported whenever the discriminant is <= 0, so a double
+// root shows up twice (and is flagged ROOTS_ILL_CONDITIONED).
+void solveCubics(const float* a, const float* b, const float* c, const float* d, size_t n,
+                 float* roots, uint8_t* counts, uint8_t* flags);
+
+// Single-equation conveniences; return the number of real roots.
+int solveQuadratic(float a, float b, float c, float roots[2]);
+int solveCubic(float a, float b, float c, float d, float roots[3]);
+
+#endif // POLYSOLVER_HPP
@@ -0,0 +1,108 @@
+#include "RefinementScheduler.hpp"
+#include <algorithm>
+#include <chrono>
+#include "FrameArena.hpp"
+#include "JobSystem.hpp"
+
+RefinementScheduler::RefinementScheduler()
+    : budget(2.0), coarseSteps(2), pendingCount(0), pendingSampleCount(0) {
+}
+
+void RefinementScheduler::setBudget(double milliseconds) {
+    budget = milliseconds;
+}
+
+void RefinementScheduler::setCoarseSteps(int steps) {
+    coarseSteps = glm::max(steps, 1);
+}
+
+void RefinementScheduler::reset(size_t segmentCount) {
+    caches.resize(segmentCount);
+    for (size_t i = 0; i < caches.size(); ++i)
+        caches[i].steps = 0;
+}
+
+void RefinementScheduler::invalidate(int segment) {
+    if (segment >= 0 && segment < (int)caches.size())
+        caches[segment].steps = 0;
+}
+
+void RefinementScheduler::tessellate(const CubicSegment& segment, int index, int steps) {
+    Cache& cache = caches[index];
+    cache.samples.clear();
+    tessellateSegment(segment, steps, false, cache.samples);
+    cache.steps = steps;
+}
+
+// Tessellates wanted[items[k]] at the wanted or the coarse level. Every item
+// writes only its own segment's cache, so items can run concurrently.
+void RefinementScheduler::tessellateItems(const std::vector<CubicSegment>& segments, const std::vector<SegmentDraw>& wanted,
+                                          const int* items, size_t count, bool coarse, JobSystem* jobs) {
+    auto work = [&](size_t begin, size_t end) {
+        for (size_t k = begin; k < end; ++k) {
+            const SegmentDraw& item = wanted[items[k]];
+            tessellate(segments[item.segment], item.segment, coarse ? glm::min(coarseSteps, item.steps) : item.steps);
+        }
+    };
+    if (jobs)
+        jobs->parallelFor(count, glm::max(count / (2 * (size_t)jobs->threadCount()), (size_t)1), work);
+    else
+        work(0, count);
+}
+
+bool RefinementScheduler::update(const std::vector<CubicSegment>& segments, const std::vector<SegmentDraw>& wanted,
+                                 JobSystem* jobs, FrameArena* arena) {
+    typedef std::chrono::steady_clock Clock;
+    Clock::time_point start = Clock::now();
+    if (caches.size() != segments.size())
+        reset(segments.size());
+
+    // Indices into the wanted list.
+    ArenaVector<int> coarse{ArenaAllocator<int>(arena)};
+    ArenaVector<int> pending{ArenaAllocator<int>(arena)};
+    coarse.reserve(wanted.size());
+    pending.reserve(wanted.size());
+
+    // Coarse level immediately, whatever the budget.
+    for (size_t i = 0; i < wanted.size(); ++i)
+        if (caches[wanted[i].segment].steps == 0)
+            coarse.push_back((int)i);
+    tessellateItems(segments, wanted, coarse.data(), coarse.size(), true, jobs);
+    bool changed = !coarse.empty();
+
+    for (size_t i = 0; i < wanted.size(); ++i)
+        if (caches[wanted[i].segment].steps != wanted[i].steps)
+            pending.push_back((int)i);
+
+    // The wanted step count grows with on-screen size and curvature: refine the biggest first.
+    std::sort(pending.begin(), pending.end(), [&](int a, int b) {
+        return wanted[a].steps > wanted[b].steps;
+    });
+
+    // One segment at a time serially; a few per thread between budget checks in parallel.
+    size_t batch = jobs ? 4 * (size_t)jobs->threadCount() : 1;
+    size_t done = 0;
+    while (done < pending.size()) {
+        double elapsed = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        if (elapsed >= budget)
+            break;
+        size_t count = glm::min(batch, pending.size() - done);
+        tessellateItems(segments, wanted, &pending[done], count, false, jobs);
+        done += count;
+        changed = true;
+    }
+
+    pendingCount = pending.size() - done;
+    pendingSampleCount = 0;
+    for (size_t i = done; i < pending.size(); ++i)
+        pendingSampleCount += wanted[pending[i]].steps + 1;
+    return changed;
+}
+
+void RefinementScheduler::assemble(const std::vector<SegmentDraw>& wanted, bool closed,
+                                   std::vector<glm::vec3>& out, std::vector<PolylineRun>& runs) const {
+    buildRuns(wanted, (int)caches.size(), closed, out, runs, [&](int item, bool skipFirst) {
+        const std::vector<glm::vec3>& samples = caches[wanted[item].segment].samples;
+        out.insert(out.end(), samples.begin() + (skipFirst ? 1 : 0), samples.end());
+    });
+}
@@ -0,0 +1,65 @@
+#ifndef REFINEMENTSCHEDULER_HPP
+#define REFINEMENTSCHEDULER_HPP
+
+#include <vector>
+#include <glm/glm.hpp>
+#include "Tessellator.hpp"
+
+class FrameArena;
+class JobSystem;
+
+// Spreads tessellation over several frames. Every segment keeps its own cache
+// of samples. A segment with no samples (new, or edited) is tessellated at a
+// coarse level right away, so something is always drawn. Segments whose cached
+// level differs from the wanted one are then refined, most detailed on screen
+// first, until the per-frame time budget is spent; the rest wait for the next
+// frame and keep drawing their previous samples.
+class RefinementScheduler {
+public:
+    RefinementScheduler();
+
+    // Per-frame refinement budget in milliseconds.
+    void setBudget(double milliseconds);
+    // Step count used for segments that have no samples yet.
+    void setCoarseSteps(int steps);
+
+    // Start over with segmentCount empty caches.
+    void reset(size_t segmentCount);
+    // The segment's geometry changed; its samples are dropped.
+    void invalidate(int segment);
+
+    // Brings the caches of the wanted segments towards their wanted level.
+    // Returns true when any cache changed this frame. With a job system the
+    // segments are tessellated in parallel, in batches between budget checks;
+    // the samples are the same either way. The work lists come from the arena
+    // when one is given.
+    bool update(const std::vector<CubicSegment>& segments, const std::vector<SegmentDraw>& wanted,
+                JobSystem* jobs = nullptr, FrameArena* arena = nullptr);
+
+    // Joins the cached samples of the wanted segments into runs, as tessellateDrawList would.
+    void assemble(const std::vector<SegmentDraw>& wanted, bool closed,
+                  std::vector<glm::vec3>& out, std::vector<PolylineRun>& runs) const;
+
+    // Work left after the last update().
+    size_t pendingSegments() const { return pendingCount; }
+    size_t pendingSamples() const { return pendingSampleCount; }
+
+private:
+    void tessellate(const CubicSegment& segment, int index, int steps);
+
+    struct Cache {
+        int steps; // 0 when empty
+        std::vector<glm::vec3> samples;
+    };
+
+    double budget;
+    int coarseSteps;
+    std::vector<Cache> caches;
+    void tessellateItems(const std::vector<CubicSegment>& segments, const std::vector<SegmentDraw>& wanted,
+                         const int* items, size_t count, bool coarse, JobSystem* jobs);
+
+    size_t pendingCount;
+    size_t pendingSampleCount;
+};
+
+#endif // REFINEMENTSCHEDULER_HPP
@@ -0,0 +1,417 @@
+#include "SceneArchive.hpp"
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include "JobSystem.hpp"
+
+namespace {
+
+const size_t kMaxChunkPoints = 1 << 20;
+// Smallest chunk that holds a point: eight streams of a mode byte and one varint.
+const uint32_t kMinChunkBytes = 16;
+const float kWeightStep = 1.0f / 65536.0f;
+
+bool littleEndianHost() {
+    uint32_t one = 1;
+    unsigned char first;
+    memcpy(&first, &one, 1);
+    return first == 1;
+}
+
+bool seekTo(FILE* file, uint64_t offset) {
+#ifdef _WIN32
+    return _fseeki64(file, (long long)offset, SEEK_SET) == 0;
+#else
+    return fseeko(file, (off_t)offset, SEEK_SET) == 0;
+#endif
+}
+
+template <typename T>
+bool readArray(FILE* file, std::vector<T>& values, size_t count) {
+    values.resize(count);
+    return count == 0 || fread(values.data(), sizeof(T), count, file) == count;
+}
+
+uint64_t zigzag(int64_t v) {
+    return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+int64_t unzigzag(uint64_t u) {
+    return (int64_t)(u >> 1) ^ -(int64_t)(u & 1);
+}
+
+void putVarint(std::vector<unsigned char>& out, uint64_t v) {
+    while (v >= 0x80) {
+        out.push_back((unsigned char)(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back((unsigned char)v);
+}
+
+size_t varintBytes(uint64_t v) {
+    size_t bytes = 1;
+    for (; v >= 0x80; v >>= 7)
+        ++bytes;
+    return bytes;
+}
+
+// One stream of a chunk: constant if every value is the same, otherwise
+// first or second differences, whichever is smaller. Points along a smooth
+// curve move almost linearly, so their second differences stay near zero.
+void putStream(std::vector<unsigned char>& out, const std::vector<int64_t>& values) {
+    bool constant = true;
+    size_t deltaBytes = 0, delta2Bytes = 0;
+    for (size_t i = 1; i < values.size(); ++i) {
+        constant = constant && values[i] == values[0];
+        int64_t delta = values[i] - values[i - 1];
+        deltaBytes += varintBytes(zigzag(delta));
+        delta2Bytes += varintBytes(zigzag(i > 1 ? delta - (values[i - 1] - values[i - 2]) : delta));
+    }
+    SceneArchiveStreamMode mode = constant ? kArchiveConstant : delta2Bytes < deltaBytes ? kArchiveDelta2 : kArchiveDelta;
+    out.push_back(mode);
+    putVarint(out, zigzag(values[0]));
+    for (size_t i = 1; i < values.size() && mode != kArchiveConstant; ++i) {
+        int64_t delta = values[i] - values[i - 1];
+        if (mode == kArchiveDelta2 && i > 1)
+            delta -= values[i - 1] - values[i - 2];
+        putVarint(out, zigzag(delta));
+    }
+}
+
+// Bounds-checked cursor over a chunk; any overrun clears ok.
+struct ChunkReader {
+    const unsigned char* p;
+    const unsigned char* end;
+    bool ok;
+
+    uint64_t varint() {
+        if (p < end && *p < 0x80) // most differences fit one byte
+            return *p++;
+        uint64_t v = 0;
+        for (int shift = 0; shift < 64 && p < end; shift += 7) {
+            unsigned char byte = *p++;
+            v |= (uint64_t)(byte & 0x7f) << shift;
+            if (!(byte & 0x80))
+                return v;
+        }
+        ok = false;
+        return 0;
+    }
+
+    // Calls store(i, value) for the count values of one stream.
+    template <typename Store>
+    void stream(size_t count, const Store& store) {
+        if (p >= end) {
+            ok = false;
+            return;
+        }
+        unsigned char mode = *p++;
+        uint64_t value = (uint64_t)unzigzag(varint());
+        if (mode == kArchiveConstant) {
+            for (size_t i = 0; i < count; ++i)
+                store(i, (int64_t)value);
+        } else if (mode == kArchiveDelta || mode == kArchiveDelta2) {
+            // Unsigned, so corrupt input wraps instead of overflowing.
+            store(0, (int64_t)value);
+            if (count < 2)
+                return;
+            uint64_t delta = (uint64_t)unzigzag(varint());
+            value += delta;
+            store(1, (int64_t)value);
+            for (size_t i = 2; i < count && ok; ++i) {
+                if (mode == kArchiveDelta)
+                    delta = (uint64_t)unzigzag(varint());
+                else
+                    delta += (uint64_t)unzigzag(varint());
+                value += delta;
+                store(i, (int64_t)value);
+            }
+        } else {
+            ok = false;
+        }
+    }
+};
+
+} // namespace
+
+SceneArchive::SceneArchive() : file(nullptr), bytes(0) {
+    memset(&header, 0, sizeof(header));
+}
+
+SceneArchive::~SceneArchive() {
+    close();
+}
+
+bool SceneArchive::isArchive(const std::string& path) {
+    FILE* f = fopen(path.c_str(), "rb");
+    if (!f)
+        return false;
+    char magic[4];
+    bool archive = fread(magic, 1, 4, f) == 4 && memcmp(magic, "P2SZ", 4) == 0;
+    fclose(f);
+    return archive;
+}
+
+bool SceneArchive::open(const std::string& archivePath) {
+    close();
+    if (!littleEndianHost()) {
+        fprintf(stderr, "%s: scene archives are little-endian; this host is not\n", archivePath.c_str());
+        return false;
+    }
+    file = fopen(archivePath.c_str(), "rb");
+    if (!file || !seekTo(file, 0) || fseek(file, 0, SEEK_END) != 0) {
+        fprintf(stderr, "Could not read scene archive %s\n", archivePath.c_str());
+        close();
+        return false;
+    }
+#ifdef _WIN32
+    long long size = _ftelli64(file);
+#else
+    long long size = (long long)ftello(file);
+#endif
+    path = archivePath;
+    bytes = size > 0 ? (size_t)size : 0;
+    if (bytes < sizeof(SceneArchiveHeader) || !seekTo(file, 0) || fread(&header, sizeof(header), 1, file) != 1 ||
+        memcmp(header.magic, "P2SZ", 4) != 0 || header.version != kSceneArchiveVersion) {
+        fprintf(stderr, "%s is not a version %u scene archive\n", path.c_str(), kSceneArchiveVersion);
+        close();
+        return false;
+    }
+    // Every table has to fit the file before anything is allocated for it.
+    uint64_t tableBytes = bytes - sizeof(SceneArchiveHeader);
+    // Rounded up without the sum that wraps for a pointCount near 2^64.
+    uint64_t expectedChunks = header.chunkPoints ? header.pointCount / header.chunkPoints +
+                                                       (header.pointCount % header.chunkPoints != 0) : 0;
+    if (header.chunkPoints == 0 || header.chunkPoints > kMaxChunkPoints || !(header.positionStep > 0.0f) ||
+        !std::isfinite(header.positionStep) || !(header.weightStep > 0.0f) || !std::isfinite(header.weightStep) ||
+        header.chunkCount != expectedChunks || header.curveCount > tableBytes / sizeof(SceneCurve) ||
+        header.knotCount > tableBytes / sizeof(float) || header.chunkCount > tableBytes / sizeof(SceneArchiveChunk) ||
+        header.curveCount * sizeof(SceneCurve) + header.knotCount * sizeof(float) +
+                header.chunkCount * sizeof(SceneArchiveChunk) > tableBytes ||
+        !readArray(file, curveTable, (size_t)header.curveCount) || !readArray(file, knotValues, (size_t)header.knotCount) ||
+        !readArray(file, chunks, header.chunkCount)) {
+        fprintf(stderr, "%s: truncated or corrupt scene archive header\n", path.c_str());
+        close();
+        return false;
+    }
+    uint64_t payloadStart = sizeof(SceneArchiveHeader) + header.curveCount * sizeof(SceneCurve) +
+                            header.knotCount * sizeof(float) + header.chunkCount * sizeof(SceneArchiveChunk);
+    for (size_t c = 0; c < chunks.size(); ++c) {
+        const SceneArchiveChunk& chunk = chunks[c];
+        uint64_t points = glm::min<uint64_t>(header.chunkPoints, header.pointCount - (uint64_t)c * header.chunkPoints);
+        if (chunk.pointCount != points || chunk.bytes < kMinChunkBytes || chunk.offset < payloadStart ||
+            chunk.offset > bytes || chunk.bytes > bytes - chunk.offset) {
+            fprintf(stderr, "%s: corrupt chunk %zu\n", path.c_str(), c);
+            close();
+            return false;
+        }
+    }
+    for (size_t c = 0; c < curveTable.size(); ++c) {
+        const SceneCurve& curve = curveTable[c];
+        if (curve.firstPoint > header.pointCount || curve.pointCount > header.pointCount - curve.firstPoint ||
+            curve.firstKnot > header.knotCount || curve.knotCount > header.knotCount - curve.firstKnot) {
+            fprintf(stderr, "%s: corrupt curve %zu\n", path.c_str(), c);
+            close();
+            return false;
+        }
+    }
+    // Constant streams let a small file claim any number of points, so a
+    // count that cannot be held is reported rather than thrown.
+    size_t points = (size_t)header.pointCount;
+    try {
+        if (header.pointCount > xs.max_size() || header.pointCount > colorValues.max_size())
+            throw std::length_error("pointCount");
+        xs.assign(points, 0.0f);
+        ys.assign(points, 0.0f);
+        zs.assign(points, 0.0f);
+        ws.assign(points, 0.0f);
+        colorValues.assign(points, 0);
+    } catch (const std::exception&) {
+        fprintf(stderr, "%s: %llu points do not fit in memory\n", path.c_str(), (unsigned long long)header.pointCount);
+        close();
+        return false;
+    }
+    return true;
+}
+
+void SceneArchive::close() {
+    if (file)
+        fclose(file);
+    file = nullptr;
+    bytes = 0;
+    memset(&header, 0, sizeof(header));
+    curveTable.clear();
+    knotValues.clear();
+    chunks.clear();
+    xs.clear();
+    ys.clear();
+    zs.clear();
+    ws.clear();
+    colorValues.clear();
+}
+
+bool SceneArchive::decodeChunk(size_t chunk) {
+    std::vector<unsigned char> data(chunks[chunk].bytes);
+    {
+        std::lock_guard<std::mutex> lock(fileMutex);
+        if (!seekTo(file, chunks[chunk].offset) || (!data.empty() && fread(data.data(), 1, data.size(), file) != data.size())) {
+            fprintf(stderr, "%s: could not read chunk %zu\n", path.c_str(), chunk);
+            return false;
+        }
+    }
+    if (!decode(chunk, data.data(), data.size())) {
+        fprintf(stderr, "%s: corrupt chunk %zu\n", path.c_str(), chunk);
+        return false;
+    }
+    return true;
+}
+
+bool SceneArchive::decode(size_t chunk, const unsigned char* data, size_t size) {
+    size_t first = chunkFirstPoint(chunk);
+    size_t count = chunkPointCount(chunk);
+    if (count == 0)
+        return size == 0;
+    ChunkReader reader = { data, data + size, true };
+    double positionStep = header.positionStep, weightStep = header.weightStep;
+    float* positions[3] = { &xs[first], &ys[first], &zs[first] };
+    for (int s = 0; s < 3; ++s) {
+        float* out = positions[s];
+        reader.stream(count, [&](size_t i, int64_t q) { out[i] = (float)((double)q * positionStep); });
+    }
+    float* weights = &ws[first];
+    reader.stream(count, [&](size_t i, int64_t q) { weights[i] = (float)((double)q * weightStep); });
+    uint32_t* colors = &colorValues[first];
+    for (int channel = 0; channel < 4; ++channel) {
+        uint32_t mask = ~(0xffu << (8 * channel));
+        reader.stream(count, [&](size_t i, int64_t v) {
+            if (v < 0 || v > 255)
+                reader.ok = false;
+            colors[i] = (colors[i] & mask) | ((uint32_t)v & 0xff) << (8 * channel);
+        });
+    }
+    return reader.ok && reader.p == reader.end;
+}
+
+bool SceneArchive::load(JobSystem* jobs) {
+    return decodeChunks(0, chunks.size(), jobs);
+}
+
+bool SceneArchive::loadCurve(size_t index, JobSystem* jobs) {
+    const SceneCurve& c = curve(index);
+    if (c.pointCount == 0)
+        return true;
+    size_t first = (size_t)(c.firstPoint / header.chunkPoints);
+    size_t last = (size_t)((c.firstPoint + c.pointCount - 1) / header.chunkPoints);
+    return decodeChunks(first, last + 1, jobs);
+}
+
+bool SceneArchive::decodeChunks(size_t first, size_t end, JobSystem* jobs) {
+    std::atomic<bool> ok(true);
+    if (jobs) {
+        jobs->parallelFor(end - first, 1, [&](size_t begin, size_t stop) {
+            for (size_t c = first + begin; c < first + stop; ++c)
+                if (!decodeChunk(c))
+                    ok.store(false, std::memory_order_relaxed);
+        });
+    } else {
+        for (size_t c = first; c < end; ++c)
+            if (!decodeChunk(c))
+                ok.store(false, std::memory_order_relaxed);
+    }
+    return ok.load();
+}
+
+glm::vec3 SceneArchive::color(size_t point) const {
+    return glm::vec3(glm::unpackUnorm4x8(colorValues[point]));
+}
+
+void SceneArchive::curvePoints(size_t index, std::vector<glm::vec3>& positions, std::vector<glm::vec3>& outColors) const {
+    const SceneCurve& c = curve(index);
+    for (uint64_t i = c.firstPoint; i < c.firstPoint + c.pointCount; ++i) {
+        positions.push_back(position((size_t)i));
+        outColors.push_back(color((size_t)i));
+    }
+}
+
+bool SceneArchive::write(const std::string& path, const SceneWriter& scene, float positionStep, size_t chunkPoints) {
+    if (!littleEndianHost()) {
+        fprintf(stderr, "Scene archives can only be written on little-endian hosts\n");
+        return false;
+    }
+    if (!(positionStep > 0.0f) || !std::isfinite(positionStep) || chunkPoints == 0 || chunkPoints > kMaxChunkPoints) {
+        fprintf(stderr, "Bad scene archive settings for %s\n", path.c_str());
+        return false;
+    }
+    // Quantized streams must stay within int32 so every delta fits a 64-bit zigzag.
+    const double kLimit = 2147483647.0;
+    size_t pointCount = scene.x.size();
+    size_t chunkCount = (pointCount + chunkPoints - 1) / chunkPoints;
+    std::vector<SceneArchiveChunk> index(chunkCount);
+    std::vector<unsigned char> payload;
+    std::vector<int64_t> values;
+    for (size_t c = 0; c < chunkCount; ++c) {
+        size_t first = c * chunkPoints;
+        size_t count = glm::min(chunkPoints, pointCount - first);
+        index[c].offset = payload.size(); // made absolute below
+        index[c].pointCount = (uint32_t)count;
+        const std::vector<float>* streams[4] = { &scene.x, &scene.y, &scene.z, &scene.w };
+        for (int s = 0; s < 4; ++s) {
+            double step = s < 3 ? positionStep : kWeightStep;
+            values.resize(count);
+            for (size_t i = 0; i < count; ++i) {
+                double q = std::floor((double)(*streams[s])[first + i] / step + 0.5);
+                if (!(std::fabs(q) <= kLimit)) {
+                    fprintf(stderr, "%s: value %g does not fit a step of %g\n", path.c_str(), (*streams[s])[first + i], step);
+                    return false;
+                }
+                values[i] = (int64_t)q;
+            }
+            putStream(payload, values);
+        }
+        for (int channel = 0; channel < 4; ++channel) {
+            for (size_t i = 0; i < count; ++i)
+                values[i] = (scene.colors[first + i] >> (8 * channel)) & 0xff;
+            putStream(payload, values);
+        }
+        index[c].bytes = (uint32_t)(payload.size() - index[c].offset);
+    }
+
+    SceneArchiveHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, "P2SZ", 4);
+    h.version = kSceneArchiveVersion;
+    h.curveCount = scene.curves.size();
+    h.pointCount = pointCount;
+    h.knotCount = scene.knots.size();
+    h.chunkCount = (uint32_t)chunkCount;
+    h.chunkPoints = (uint32_t)chunkPoints;
+    h.positionStep = positionStep;
+    h.weightStep = kWeightStep;
+    uint64_t payloadStart = sizeof(h) + scene.curves.size() * sizeof(SceneCurve) + scene.knots.size() * sizeof(float) +
+                            chunkCount * sizeof(SceneArchiveChunk);
+    for (size_t c = 0; c < chunkCount; ++c)
+        index[c].offset += payloadStart;
+
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file) {
+        fprintf(stderr, "Could not write scene archive %s\n", path.c_str());
+        return false;
+    }
+    fwrite(&h, sizeof(h), 1, file);
+    if (!scene.curves.empty())
+        fwrite(scene.curves.data(), sizeof(SceneCurve), scene.curves.size(), file);
+    if (!scene.knots.empty())
+        fwrite(scene.knots.data(), sizeof(float), scene.knots.size(), file);
+    if (!index.empty())
+        fwrite(index.data(), sizeof(SceneArchiveChunk), index.size(), file);
+    if (!payload.empty())
+        fwrite(payload.data(), 1, payload.size(), file);
+    bool ok = !ferror(file);
+    if (fclose(file) != 0)
+        ok = false;
+    if (!ok)
+        fprintf(stderr, "Error writing scene archive %s\n", path.c_str());
+    return ok;
+}
@@ -0,0 +1,136 @@
+#ifndef SCENEARCHIVE_HPP
+#define SCENEARCHIVE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include "SceneFile.hpp"
+
+class JobSystem;
+
+// Compressed scene file for archiving and transfer; SceneFile is the raw,
+// mappable form of the same data.
+//
+// Layout, all little-endian:
+//   header       SceneArchiveHeader, 64 bytes
+//   curve table  curveCount SceneCurve entries, as in SceneFile
+//   knots        knotCount floats
+//   chunk index  chunkCount SceneArchiveChunk entries
+//   chunks       the control points, chunkPoints at a time (the last may hold fewer)
+// A chunk holds eight streams one after the other: x, y, z, w and the r, g, b,
+// a bytes of the color. Positions are rounded to multiples of positionStep and
+// weights to multiples of weightStep. Each stream starts with a mode byte:
+// kArchiveConstant is followed by one value for the whole chunk, kArchiveDelta
+// by the first value and then the difference of every point to the one
+// before it, kArchiveDelta2 by the first value, the first difference and then
+// the change of the difference from point to point. Values are zigzag-encoded
+// LEB128 varints. Chunks depend on nothing but the header, so they decode
+// independently, in any order.
+const uint32_t kSceneArchiveVersion = 1;
+
+enum SceneArchiveStreamMode : uint8_t {
+    kArchiveConstant = 0,
+    kArchiveDelta = 1,
+    kArchiveDelta2 = 2,
+};
+
+struct SceneArchiveHeader {
+    char magic[4]; // "P2SZ"
+    uint32_t version;
+    uint64_t curveCount;
+    uint64_t pointCount;
+    uint64_t knotCount;
+    uint32_t chunkCount;
+    uint32_t chunkPoints;
+    float positionStep;
+    float weightStep;
+    uint64_t reserved[2];
+};
+
+struct SceneArchiveChunk {
+    uint64_t offset; // from the start of the file
+    uint32_t bytes;
+    uint32_t pointCount;
+};
+
+static_assert(sizeof(SceneArchiveHeader) == 64, "SceneArchiveHeader is part of the file format");
+static_assert(sizeof(SceneArchiveChunk) == 16, "SceneArchiveChunk is part of the file format");
+
+// Reads a scene archive. open() reads the header, curve table and chunk
+// index; load() then reads and decodes the chunks, in parallel when given a
+// job system, and loadCurve() only those holding one curve. A point's
+// accessors are only meaningful once its chunk was decoded.
+class SceneArchive {
+public:
+    SceneArchive();
+    ~SceneArchive();
+
+    SceneArchive(const SceneArchive&) = delete;
+    SceneArchive& operator=(const SceneArchive&) = delete;
+
+    // True if the file starts like an archive; lets --scene take either format.
+    static bool isArchive(const std::string& path);
+
+    // Prints why on failure.
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const { return file != nullptr; }
+
+    // Decodes every chunk, in parallel when jobs is given.
+    bool load(JobSystem* jobs);
+    // Decodes just the chunks that hold the points of one curve.
+    bool loadCurve(size_t curve, JobSystem* jobs);
+
+    size_t chunkCount() const { return chunks.size(); }
+    size_t chunkFirstPoint(size_t chunk) const { return chunk * header.chunkPoints; }
+    size_t chunkPointCount(size_t chunk) const { return chunks[chunk].pointCount; }
+    // Bytes of the whole file.
+    size_t fileBytes() const { return bytes; }
+
+    size_t curveCount() const { return curveTable.size(); }
+    size_t pointCount() const { return xs.size(); }
+    size_t knotCount() const { return knotValues.size(); }
+    const SceneCurve& curve(size_t index) const { return curveTable[index]; }
+
+    // The decoded streams, laid out as SceneFile's.
+    const float* x() const { return xs.data(); }
+    const float* y() const { return ys.data(); }
+    const float* z() const { return zs.data(); }
+    const float* w() const { return ws.data(); }
+    const uint32_t* colors() const { return colorValues.data(); }
+    const float* knots() const { return knotValues.data(); }
+
+    glm::vec3 position(size_t point) const { return glm::vec3(xs[point], ys[point], zs[point]); }
+    glm::vec3 color(size_t point) const;
+    // Appends one curve's points and colors.
+    void curvePoints(size_t curve, std::vector<glm::vec3>& positions, std::vector<glm::vec3>& colors) const;
+
+    // Compresses a scene. positionStep bounds the position error to half of
+    // it; weights keep 16 fractional bits. Prints why on failure.
+    static bool write(const std::string& path, const SceneWriter& scene, float positionStep = 1.0f / 4096.0f,
+                      size_t chunkPoints = 4096);
+
+private:
+    // Reads and decodes one chunk. Distinct chunks may be decoded on different
+    // threads at once; only the file read is serialized.
+    bool decodeChunk(size_t chunk);
+    bool decodeChunks(size_t first, size_t end, JobSystem* jobs);
+    bool decode(size_t chunk, const unsigned char* data, size_t size);
+
+    FILE* file;
+    std::mutex fileMutex; // one reader at a time on file
+    std::string path;
+    size_t bytes;
+    SceneArchiveHeader header;
+    std::vector<SceneCurve> curveTable;
+    std::vector<float> knotValues;
+    std::vector<SceneArchiveChunk> chunks;
+    std::vector<float> xs, ys, zs, ws;
+    std::vector<uint32_t> colorValues;
+};
+
+#endif // SCENEARCHIVE_HPP
@@ -0,0 +1,237 @@
+#include "SceneFile.hpp"
+#include <cstdio>
+#include <cstring>
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const uint64_t kSectionAlignment = 64;
+
+uint64_t alignUp(uint64_t offset) {
+    return (offset + kSectionAlignment - 1) / kSectionAlignment * kSectionAlignment;
+}
+
+bool littleEndianHost() {
+    uint32_t one = 1;
+    unsigned char first;
+    memcpy(&first, &one, 1);
+    return first == 1;
+}
+
+// count elements of elementBytes at offset lie inside the file, without overflow.
+bool sectionFits(uint64_t offset, uint64_t count, uint64_t elementBytes, uint64_t fileBytes) {
+    if (offset % kSectionAlignment != 0 || offset > fileBytes)
+        return false;
+    return count <= (fileBytes - offset) / elementBytes;
+}
+
+// Writes a section and pads it to the next 64-byte boundary.
+template <typename T>
+void writeSection(FILE* file, const std::vector<T>& values, uint64_t& offset) {
+    static const unsigned char zeros[kSectionAlignment] = {};
+    size_t bytes = values.size() * sizeof(T);
+    if (bytes)
+        fwrite(values.data(), 1, bytes, file);
+    offset += bytes;
+    uint64_t padded = alignUp(offset);
+    fwrite(zeros, 1, (size_t)(padded - offset), file);
+    offset = padded;
+}
+
+} // namespace
+
+SceneFile::SceneFile() : data(nullptr), bytes(0) {
+#ifdef _WIN32
+    fileHandle = INVALID_HANDLE_VALUE;
+    mappingHandle = nullptr;
+#endif
+}
+
+SceneFile::~SceneFile() {
+    close();
+}
+
+bool SceneFile::open(const std::string& path) {
+    close();
+    if (!littleEndianHost()) {
+        fprintf(stderr, "%s: scene files are little-endian and are used in place; this host is not\n", path.c_str());
+        return false;
+    }
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    LARGE_INTEGER size;
+    if (file == INVALID_HANDLE_VALUE || !GetFileSizeEx(file, &size) || size.QuadPart < (LONGLONG)sizeof(SceneHeader)) {
+        fprintf(stderr, "Could not read scene %s\n", path.c_str());
+        if (file != INVALID_HANDLE_VALUE)
+            CloseHandle(file);
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+    if (!view) {
+        fprintf(stderr, "Could not map scene %s\n", path.c_str());
+        if (mapping)
+            CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    fileHandle = file;
+    mappingHandle = mapping;
+    data = static_cast<const unsigned char*>(view);
+    bytes = (size_t)size.QuadPart;
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    struct stat info;
+    if (fd < 0 || fstat(fd, &info) != 0 || info.st_size < (off_t)sizeof(SceneHeader)) {
+        fprintf(stderr, "Could not read scene %s\n", path.c_str());
+        if (fd >= 0)
+            ::close(fd);
+        return false;
+    }
+    void* view = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // the mapping keeps the file
+    if (view == MAP_FAILED) {
+        fprintf(stderr, "Could not map scene %s\n", path.c_str());
+        return false;
+    }
+    data = static_cast<const unsigned char*>(view);
+    bytes = (size_t)info.st_size;
+#endif
+    if (!validate(path)) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void SceneFile::close() {
+    if (!data)
+        return;
+#ifdef _WIN32
+    UnmapViewOfFile(data);
+    CloseHandle(mappingHandle);
+    CloseHandle(fileHandle);
+    fileHandle = INVALID_HANDLE_VALUE;
+    mappingHandle = nullptr;
+#else
+    munmap(const_cast<unsigned char*>(data), bytes);
+#endif
+    data = nullptr;
+    bytes = 0;
+}
+
+bool SceneFile::validate(const std::string& path) const {
+    const SceneHeader& h = header();
+    if (memcmp(h.magic, "P2SC", 4) != 0 || h.version != kSceneFileVersion) {
+        fprintf(stderr, "%s is not a version %u scene file\n", path.c_str(), kSceneFileVersion);
+        return false;
+    }
+    uint64_t size = bytes;
+    if (h.fileBytes != size || !sectionFits(h.curveTableOffset, h.curveCount, sizeof(SceneCurve), size) ||
+        !sectionFits(h.xOffset, h.pointCount, sizeof(float), size) || !sectionFits(h.yOffset, h.pointCount, sizeof(float), size) ||
+        !sectionFits(h.zOffset, h.pointCount, sizeof(float), size) || !sectionFits(h.wOffset, h.pointCount, sizeof(float), size) ||
+        !sectionFits(h.colorOffset, h.pointCount, sizeof(uint32_t), size) ||
+        !sectionFits(h.knotOffset, h.knotCount, sizeof(float), size)) {
+        fprintf(stderr, "%s: truncated or corrupt scene header\n", path.c_str());
+        return false;
+    }
+    const SceneCurve* table = curves();
+    for (uint64_t c = 0; c < h.curveCount; ++c) {
+        const SceneCurve& curve = table[c];
+        if (curve.firstPoint > h.pointCount || curve.pointCount > h.pointCount - curve.firstPoint ||
+            curve.firstKnot > h.knotCount || curve.knotCount > h.knotCount - curve.firstKnot) {
+            fprintf(stderr, "%s: corrupt curve %llu\n", path.c_str(), (unsigned long long)c);
+            return false;
+        }
+    }
+    return true;
+}
+
+glm::vec3 SceneFile::color(size_t point) const {
+    return glm::vec3(glm::unpackUnorm4x8(colors()[point]));
+}
+
+void SceneFile::curvePoints(size_t index, std::vector<glm::vec3>& positions, std::vector<glm::vec3>& outColors) const {
+    const SceneCurve& c = curve(index);
+    for (uint64_t i = c.firstPoint; i < c.firstPoint + c.pointCount; ++i) {
+        positions.push_back(position((size_t)i));
+        outColors.push_back(color((size_t)i));
+    }
+}
+
+void SceneWriter::addCurve(const std::vector<glm::vec3>& points, const std::vector<glm::vec3>& pointColors, bool closed,
+                           int degree, const std::vector<float>& weights, const std::vector<float>& curveKnots) {
+    SceneCurve curve;
+    curve.firstPoint = x.size();
+    curve.pointCount = (uint32_t)points.size();
+    curve.knotCount = (uint32_t)curveKnots.size();
+    curve.firstKnot = knots.size();
+    curve.degree = (uint16_t)degree;
+    curve.flags = (closed ? kSceneCurveClosed : 0) | (!weights.empty() ? kSceneCurveRational : 0);
+    curve.reserved = 0;
+    curves.push_back(curve);
+    for (size_t i = 0; i < points.size(); ++i) {
+        x.push_back(points[i].x);
+        y.push_back(points[i].y);
+        z.push_back(points[i].z);
+        w.push_back(weights.empty() ? 1.0f : weights[i]);
+        colors.push_back(glm::packUnorm4x8(glm::vec4(i < pointColors.size() ? pointColors[i] : glm::vec3(1.0f), 1.0f)));
+    }
+    knots.insert(knots.end(), curveKnots.begin(), curveKnots.end());
+}
+
+bool SceneWriter::write(const std::string& path) const {
+    if (!littleEndianHost()) {
+        fprintf(stderr, "Scene files can only be written on little-endian hosts\n");
+        return false;
+    }
+    SceneHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, "P2SC", 4);
+    h.version = kSceneFileVersion;
+    h.curveCount = curves.size();
+    h.pointCount = x.size();
+    h.knotCount = knots.size();
+    // Section offsets, in file order.
+    uint64_t offset = alignUp(sizeof(SceneHeader));
+    h.curveTableOffset = offset;
+    offset = alignUp(offset + curves.size() * sizeof(SceneCurve));
+    uint64_t pointStream = alignUp(x.size() * sizeof(float));
+    h.xOffset = offset;
+    h.yOffset = h.xOffset + pointStream;
+    h.zOffset = h.yOffset + pointStream;
+    h.wOffset = h.zOffset + pointStream;
+    h.colorOffset = h.wOffset + pointStream;
+    h.knotOffset = h.colorOffset + alignUp(colors.size() * sizeof(uint32_t));
+    h.fileBytes = h.knotOffset + alignUp(knots.size() * sizeof(float));
+
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file) {
+        fprintf(stderr, "Could not write scene %s\n", path.c_str());
+        return false;
+    }
+    std::vector<SceneHeader> headerSection(1, h);
+    offset = 0;
+    writeSection(file, headerSection, offset);
+    writeSection(file, curves, offset);
+    writeSection(file, x, offset);
+    writeSection(file, y, offset);
+    writeSection(file, z, offset);
+    writeSection(file, w, offset);
+    writeSection(file, colors, offset);
+    writeSection(file, knots, offset);
+    bool ok = offset == h.fileBytes && !ferror(file);
+    if (fclose(file) != 0)
+        ok = false;
+    if (!ok)
+        fprintf(stderr, "Error writing scene %s\n", path.c_str());
+    return ok;
+}
@@ -0,0 +1,128 @@
+#ifndef SCENEFILE_HPP
+#define SCENEFILE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+
+// Binary scene file, laid out to be memory-mapped and used in place.
+//
+// Layout, all little-endian:
+//   header       SceneHeader, 128 bytes
+//   curve table  curveCount SceneCurve entries, 32 bytes each
+//   x, y, z, w   pointCount floats each: control point coordinates and weights
+//   colors       pointCount RGBA8 colors, glm::packUnorm4x8 order
+//   knots        knotCount floats, the knot vectors of all curves back to back
+// Every section starts on a 64-byte boundary and is zero-padded to the next
+// one, so the streams can go straight to Float4 loads (whole groups of four
+// included) and to glBufferSubData. Offsets are from the start of the file.
+// Opening validates the header and the curve table; points are not touched.
+const uint32_t kSceneFileVersion = 1;
+
+enum SceneCurveFlags : uint16_t {
+    kSceneCurveClosed = 1,
+    kSceneCurveRational = 2, // the w stream holds weights; otherwise it is all 1
+};
+
+// Curves without knots are interpolated as buildClosedCurve() does.
+struct SceneCurve {
+    uint64_t firstPoint;
+    uint32_t pointCount;
+    uint32_t knotCount;
+    uint64_t firstKnot;
+    uint16_t degree;
+    uint16_t flags;
+    uint32_t reserved;
+};
+
+struct SceneHeader {
+    char magic[4]; // "P2SC"
+    uint32_t version;
+    uint64_t fileBytes;
+    uint64_t curveCount;
+    uint64_t pointCount;
+    uint64_t knotCount;
+    uint64_t curveTableOffset;
+    uint64_t xOffset, yOffset, zOffset, wOffset;
+    uint64_t colorOffset;
+    uint64_t knotOffset;
+    uint64_t reserved[4];
+};
+
+static_assert(sizeof(SceneCurve) == 32, "SceneCurve is part of the file format");
+static_assert(sizeof(SceneHeader) == 128, "SceneHeader is part of the file format");
+
+// A mapped scene file. The accessors need an open file; the pointers they
+// return stay valid until close() or destruction.
+class SceneFile {
+public:
+    SceneFile();
+    ~SceneFile();
+
+    SceneFile(const SceneFile&) = delete;
+    SceneFile& operator=(const SceneFile&) = delete;
+
+    // Maps the file read-only. Prints why on failure.
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const { return data != nullptr; }
+    size_t fileBytes() const { return bytes; }
+
+    size_t curveCount() const { return (size_t)header().curveCount; }
+    size_t pointCount() const { return (size_t)header().pointCount; }
+    size_t knotCount() const { return (size_t)header().knotCount; }
+    const SceneCurve& curve(size_t index) const { return curves()[index]; }
+
+    // The streams, in place.
+    const SceneCurve* curves() const { return section<SceneCurve>(header().curveTableOffset); }
+    const float* x() const { return section<float>(header().xOffset); }
+    const float* y() const { return section<float>(header().yOffset); }
+    const float* z() const { return section<float>(header().zOffset); }
+    const float* w() const { return section<float>(header().wOffset); }
+    const uint32_t* colors() const { return section<uint32_t>(header().colorOffset); }
+    const float* knots() const { return section<float>(header().knotOffset); }
+
+    glm::vec3 position(size_t point) const { return glm::vec3(x()[point], y()[point], z()[point]); }
+    glm::vec3 color(size_t point) const;
+    // Appends one curve's points and colors.
+    void curvePoints(size_t curve, std::vector<glm::vec3>& positions, std::vector<glm::vec3>& colors) const;
+
+private:
+    const SceneHeader& header() const { return *reinterpret_cast<const SceneHeader*>(data); }
+    template <typename T>
+    const T* section(uint64_t offset) const { return reinterpret_cast<const T*>(data + offset); }
+    bool validate(const std::string& path) const;
+
+    const unsigned char* data;
+    size_t bytes;
+#ifdef _WIN32
+    void* fileHandle;
+    void* mappingHandle;
+#endif
+};
+
+// Collects curves and writes them as a scene file.
+class SceneWriter {
+public:
+    // colors has one entry per point; weights is empty or one per point (the
+    // curve is then rational); knots may be empty.
+    void addCurve(const std::vector<glm::vec3>& points, const std::vector<glm::vec3>& colors, bool closed,
+                  int degree = 3, const std::vector<float>& weights = std::vector<float>(),
+                  const std::vector<float>& knots = std::vector<float>());
+    bool write(const std::string& path) const;
+
+    size_t curveCount() const { return curves.size(); }
+    size_t pointCount() const { return x.size(); }
+
+private:
+    friend class SceneArchive; // compresses the collected streams
+
+    std::vector<SceneCurve> curves;
+    std::vector<float> x, y, z, w;
+    std::vector<uint32_t> colors;
+    std::vector<float> knots;
+};
+
+#endif // SCENEFILE_HPP
@@ -0,0 +1,120 @@
+#ifndef SIMD_HPP
+#define SIMD_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+
+// Minimal 4-wide float vector used by the batch curve kernels.
+// SSE2 on x86/x64, plain arrays everywhere else.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SIMD_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#ifdef SIMD_SSE2
+
+struct Mask4 {
+    __m128 v;
+};
+
+struct Float4 {
+    __m128 v;
+
+    Float4() {}
+    Float4(__m128 x) : v(x) {}
+    Float4(float x) : v(_mm_set1_ps(x)) {}
+
+    static Float4 load(const float* p) { return _mm_loadu_ps(p); }
+    void store(float* p) const { _mm_storeu_ps(p, v); }
+};
+
+inline Float4 operator+(Float4 a, Float4 b) { return _mm_add_ps(a.v, b.v); }
+inline Float4 operator-(Float4 a, Float4 b) { return _mm_sub_ps(a.v, b.v); }
+inline Float4 operator*(Float4 a, Float4 b) { return _mm_mul_ps(a.v, b.v); }
+inline Float4 operator/(Float4 a, Float4 b) { return _mm_div_ps(a.v, b.v); }
+inline Float4 operator-(Float4 a) { return _mm_xor_ps(a.v, _mm_set1_ps(-0.0f)); }
+
+inline Float4 sqrt(Float4 a) { return _mm_sqrt_ps(a.v); }
+inline Float4 min(Float4 a, Float4 b) { return _mm_min_ps(a.v, b.v); }
+inline Float4 max(Float4 a, Float4 b) { return _mm_max_ps(a.v, b.v); }
+inline Float4 abs(Float4 a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a.v); }
+// +1 for non-negative lanes (including +0), -1 otherwise.
+inline Float4 signOf(Float4 a) { return _mm_or_ps(_mm_and_ps(_mm_set1_ps(-0.0f), a.v), _mm_set1_ps(1.0f)); }
+
+inline Mask4 operator<(Float4 a, Float4 b) { return { _mm_cmplt_ps(a.v, b.v) }; }
+inline Mask4 operator<=(Float4 a, Float4 b) { return { _mm_cmple_ps(a.v, b.v) }; }
+inline Mask4 operator>(Float4 a, Float4 b) { return { _mm_cmpgt_ps(a.v, b.v) }; }
+inline Mask4 operator>=(Float4 a, Float4 b) { return { _mm_cmpge_ps(a.v, b.v) }; }
+inline Mask4 operator&(Mask4 a, Mask4 b) { return { _mm_and_ps(a.v, b.v) }; }
+inline Mask4 operator|(Mask4 a, Mask4 b) { return { _mm_or_ps(a.v, b.v) }; }
+
+// Per lane: m ? a : b
+inline Float4 select(Mask4 m, Float4 a, Float4 b) { return _mm_or_ps(_mm_and_ps(m.v, a.v), _mm_andnot_ps(m.v, b.v)); }
+// Bit i set when lane i of the mask is set.
+inline int bits(Mask4 m) { return _mm_movemask_ps(m.v); }
+
+// Cube root: exponent-thirds bit trick for the first guess, then Newton.
+inline Float4 cbrt(Float4 a) {
+    Float4 x = abs(a);
+    __m128 third = _mm_cvtepi32_ps(_mm_castps_si128(x.v));
+    __m128i guess = _mm_add_epi32(_mm_cvttps_epi32(_mm_mul_ps(third, _mm_set1_ps(1.0f / 3.0f))), _mm_set1_epi32(709958130));
+    Float4 y = _mm_castsi128_ps(guess);
+    for (int i = 0; i < 3; ++i)
+        y = (y + y + x / (y * y)) * Float4(1.0f / 3.0f);
+    Mask4 zero = { _mm_cmpeq_ps(x.v, _mm_setzero_ps()) };
+    return select(zero, Float4(0.0f), y * signOf(a));
+}
+
+#else
+
+struct Mask4 {
+    bool v[4];
+};
+
+struct Float4 {
+    float v[4];
+
+    Float4() {}
+    Float4(float x) { v[0] = v[1] = v[2] = v[3] = x; }
+
+    static Float4 load(const float* p) { Float4 r; std::memcpy(r.v, p, sizeof(r.v)); return r; }
+    void store(float* p) const { std::memcpy(p, v, sizeof(v)); }
+};
+
+#define SIMD_LANEWISE(expr) Float4 r; for (int i = 0; i < 4; ++i) r.v[i] = (expr); return r
+#define SIMD_MASKWISE(expr) Mask4 r; for (int i = 0; i < 4; ++i) r.v[i] = (expr); return r
+
+inline Float4 operator+(Float4 a, Float4 b) { SIMD_LANEWISE(a.v[i] + b.v[i]); }
+inline Float4 operator-(Float4 a, Float4 b) { SIMD_LANEWISE(a.v[i] - b.v[i]); }
+inline Float4 operator*(Float4 a, Float4 b) { SIMD_LANEWISE(a.v[i] * b.v[i]); }
+inline Float4 operator/(Float4 a, Float4 b) { SIMD_LANEWISE(a.v[i] / b.v[i]); }
+inline Float4 operator-(Float4 a) { SIMD_LANEWISE(-a.v[i]); }
+
+inline Float4 sqrt(Float4 a) { SIMD_LANEWISE(std::sqrt(a.v[i])); }
+inline Float4 min(Float4 a, Float4 b) { SIMD_LANEWISE(b.v[i] < a.v[i] ? b.v[i] : a.v[i]); }
+inline Float4 max(Float4 a, Float4 b) { SIMD_LANEWISE(b.v[i] > a.v[i] ? b.v[i] : a.v[i]); }
+inline Float4 abs(Float4 a) { SIMD_LANEWISE(std::fabs(a.v[i])); }
+inline Float4 signOf(Float4 a) { SIMD_LANEWISE(std::signbit(a.v[i]) ? -1.0f : 1.0f); }
+
+inline Mask4 operator<(Float4 a, Float4 b) { SIMD_MASKWISE(a.v[i] < b.v[i]); }
+inline Mask4 operator<=(Float4 a, Float4 b) { SIMD_MASKWISE(a.v[i] <= b.v[i]); }
+inline Mask4 operator>(Float4 a, Float4 b) { SIMD_MASKWISE(a.v[i] > b.v[i]); }
+inline Mask4 operator>=(Float4 a, Float4 b) { SIMD_MASKWISE(a.v[i] >= b.v[i]); }
+inline Mask4 operator&(Mask4 a, Mask4 b) { SIMD_MASKWISE(a.v[i] && b.v[i]); }
+inline Mask4 operator|(Mask4 a, Mask4 b) { SIMD_MASKWISE(a.v[i] || b.v[i]); }
+
+inline Float4 select(Mask4 m, Float4 a, Float4 b) { SIMD_LANEWISE(m.v[i] ? a.v[i] : b.v[i]); }
+inline Float4 cbrt(Float4 a) { SIMD_LANEWISE(std::cbrt(a.v[i])); }
+
+inline int bits(Mask4 m) { return (m.v[0] ? 1 : 0) | (m.v[1] ? 2 : 0) | (m.v[2] ? 4 : 0) | (m.v[3] ? 8 : 0); }
+
+#undef SIMD_LANEWISE
+#undef SIMD_MASKWISE
+
+#endif
+
+// a * b + c, kept unfused so SSE2 and scalar builds round identically.
+inline Float4 madd(Float4 a, Float4 b, Float4 c) { return a * b + c; }
+
+#endif // SIMD_HPP
@@ -0,0 +1,72 @@
+#include "StrokeObject.hpp"
+#include <glm/gtc/type_ptr.hpp>
+#include "common/shader.hpp"
+#include "UploadStats.hpp"
+
+StrokeObject::StrokeObject(const glm::vec3& initColor) : color(initColor), vertexCount(0), capacity(0) {
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &VBO_positions);
+    glGenBuffers(1, &VBO_edges);
+
+    shaderProgram = LoadShaders("strokeVertexShader.glsl", "strokeFragmentShader.glsl");
+
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO_positions);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
+    glEnableVertexAttribArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO_edges);
+    glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, 0, (void*)0);
+    glEnableVertexAttribArray(1);
+    glBindVertexArray(0);
+}
+
+StrokeObject::~StrokeObject() {
+    glDeleteVertexArrays(1, &VAO);
+    glDeleteBuffers(1, &VBO_positions);
+    glDeleteBuffers(1, &VBO_edges);
+    glDeleteProgram(shaderProgram);
+}
+
+void StrokeObject::upload(const std::vector<glm::vec3>& vertices, const std::vector<float>& edges) {
+    vertexCount = (GLsizei)vertices.size();
+    if (vertices.empty())
+        return;
+
+    if (vertices.size() > capacity) {
+        // Grow geometrically so a slowly growing stroke does not reallocate every frame.
+        capacity = vertices.size() + vertices.size() / 2;
+        glBindBuffer(GL_ARRAY_BUFFER, VBO_positions);
+        glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(glm::vec3), NULL, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO_edges);
+        glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(float), NULL, GL_DYNAMIC_DRAW);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, VBO_positions);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, vertices.size() * sizeof(glm::vec3), vertices.data());
+    UploadStats::add(vertices.size() * sizeof(glm::vec3));
+    glBindBuffer(GL_ARRAY_BUFFER, VBO_edges);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, edges.size() * sizeof(float), edges.data());
+    UploadStats::add(edges.size() * sizeof(float));
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void StrokeObject::draw(const glm::mat4& view, const glm::mat4& projection) {
+    if (vertexCount == 0)
+        return;
+
+    glUseProgram(shaderProgram);
+    glm::mat4 MVP = projection * view;
+    glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "MVP"), 1, GL_FALSE, glm::value_ptr(MVP));
+    glUniform3fv(glGetUniformLocation(shaderProgram, "strokeColor"), 1, glm::value_ptr(color));
+
+    // Joins fold the strip over itself, so both windings must survive.
+    glDisable(GL_CULL_FACE);
+    glBindVertexArray(VAO);
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, vertexCount);
+    glBindVertexArray(0);
+    glEnable(GL_CULL_FACE);
+    glUseProgram(0);
+}
+
+void StrokeObject::setColor(const glm::vec3& newColor) {
+    color = newColor;
+}
@@ -0,0 +1,36 @@
+#ifndef STROKEOBJECT_HPP
+#define STROKEOBJECT_HPP
+
+#include <vector>
+#include <glm/glm.hpp>
+#include <GL/glew.h>
+
+// Draws a triangle strip (for example Stroker output) in a single color, with
+// coverage from a per-vertex edge coordinate (+-1 on the stroke edges).
+class StrokeObject {
+public:
+    StrokeObject(const glm::vec3& color);
+    ~StrokeObject();
+
+    // Replace the strip. The GPU buffer only grows, so same-sized or smaller
+    // strips are written in place.
+    void upload(const std::vector<glm::vec3>& vertices, const std::vector<float>& edges);
+
+    void draw(const glm::mat4& view, const glm::mat4& projection);
+
+    void setColor(const glm::vec3& newColor);
+
+private:
+    glm::vec3 color;
+    GLsizei vertexCount;
+    size_t capacity; // in vertices
+
+    // OpenGL objects.
+    GLuint VAO;
+    GLuint VBO_positions;
+    GLuint VBO_edges;
+
+    GLuint shaderProgram;
+};
+
+#endif // STROKEOBJECT_HPP
@@ -0,0 +1,236 @@
+#include "Stroker.hpp"
+#include <cmath>
+#include "Simd.hpp"
+
+Stroker::Stroker()
+    : halfWidth(0.5f), join(JoinStyle::Miter), cap(CapStyle::Butt), miterLimit(4.0f), tolerance(0.01f), arena(nullptr),
+      bridgePending(false) {
+}
+
+void Stroker::setWidth(float width) {
+    halfWidth = 0.5f * width;
+}
+
+void Stroker::setJoin(JoinStyle newJoin) {
+    join = newJoin;
+}
+
+void Stroker::setCap(CapStyle newCap) {
+    cap = newCap;
+}
+
+void Stroker::setMiterLimit(float limit) {
+    miterLimit = limit;
+}
+
+void Stroker::setTolerance(float newTolerance) {
+    tolerance = newTolerance;
+}
+
+void Stroker::setArena(FrameArena* newArena) {
+    arena = newArena;
+}
+
+const std::vector<glm::vec3>& Stroker::stroke(const std::vector<glm::vec3>& polyline, bool closed) {
+    clear();
+    append(polyline.data(), polyline.size(), closed);
+    return out;
+}
+
+void Stroker::clear() {
+    out.clear();
+    outEdge.clear();
+    bridgePending = false;
+    // Arena scratch from before the last reset is gone: start over on fresh memory.
+    ArenaAllocator<float> floats(arena);
+    if (arena || px.get_allocator() != floats) {
+        px = ArenaVector<float>(floats);
+        py = ArenaVector<float>(floats);
+        dx = ArenaVector<float>(floats);
+        dy = ArenaVector<float>(floats);
+        nx = ArenaVector<float>(floats);
+        ny = ArenaVector<float>(floats);
+    }
+}
+
+void Stroker::append(const glm::vec3* points, size_t count, bool closed) {
+    px.clear();
+    py.clear();
+    // Room for the closing point and the padding to a multiple of four.
+    px.reserve(count + 4);
+    py.reserve(count + 4);
+
+    // Drop repeated points, they have no direction.
+    for (size_t i = 0; i < count; ++i) {
+        if (!px.empty() && points[i].x == px.back() && points[i].y == py.back())
+            continue;
+        px.push_back(points[i].x);
+        py.push_back(points[i].y);
+    }
+    if (closed && px.size() > 1 && px.front() == px.back() && py.front() == py.back()) {
+        px.pop_back();
+        py.pop_back();
+    }
+    int m = (int)px.size();
+    if (m < 2 || (closed && m < 3))
+        return;
+    bridgePending = !out.empty();
+
+    // Segment i runs from point i to point i + 1; closed strokes get the first point appended.
+    if (closed) {
+        px.push_back(px[0]);
+        py.push_back(py[0]);
+    }
+    size_t segments = px.size() - 1;
+    size_t padded = (segments + 3) & ~(size_t)3;
+    while (px.size() < padded + 1) {
+        px.push_back(px.back());
+        py.push_back(py.back());
+    }
+    dx.resize(padded);
+    dy.resize(padded);
+    nx.resize(padded);
+    ny.resize(padded);
+
+    // Unit directions and left normals, four segments at a time.
+    for (size_t i = 0; i < padded; i += 4) {
+        Float4 ex = Float4::load(&px[i + 1]) - Float4::load(&px[i]);
+        Float4 ey = Float4::load(&py[i + 1]) - Float4::load(&py[i]);
+        Float4 inv = Float4(1.0f) / sqrt(max(ex * ex + ey * ey, Float4(1e-30f)));
+        ex = ex * inv;
+        ey = ey * inv;
+        ex.store(&dx[i]);
+        ey.store(&dy[i]);
+        (-ey).store(&nx[i]);
+        ex.store(&ny[i]);
+    }
+
+    if (closed) {
+        emitJoin(0, m - 1, 0);
+        for (int v = 1; v < m; ++v)
+            emitJoin(v, v - 1, v);
+        emitJoin(0, m - 1, 0);
+    } else {
+        emitStartCap(0);
+        for (int v = 1; v < m - 1; ++v)
+            emitJoin(v, v - 1, v);
+        emitEndCap(m - 2);
+    }
+}
+
+void Stroker::emitPair(const glm::vec2& p, const glm::vec2& offset) {
+    if (bridgePending) {
+        // Repeat the previous end and the new start: two zero-area triangles, even parity kept.
+        out.push_back(out.back());
+        outEdge.push_back(outEdge.back());
+        out.push_back(glm::vec3(p + offset, 0.0f));
+        outEdge.push_back(1.0f);
+        bridgePending = false;
+    }
+    out.push_back(glm::vec3(p + offset, 0.0f));
+    out.push_back(glm::vec3(p - offset, 0.0f));
+    outEdge.push_back(1.0f);
+    outEdge.push_back(-1.0f);
+}
+
+// Pairs of vertices mirrored through p, rotating `from` by `angle` radians to `to`.
+void Stroker::emitArc(const glm::vec2& p, const glm::vec2& from, const glm::vec2& to, float angle) {
+    float maxStep = 1.5707963f;
+    if (tolerance < halfWidth)
+        maxStep = glm::min(maxStep, 2.0f * std::acos(1.0f - tolerance / halfWidth));
+    int steps = (int)std::ceil(std::fabs(angle) / maxStep);
+    for (int k = 0; k < steps; ++k) {
+        float a = angle * (float)k / (float)steps;
+        float c = std::cos(a), s = std::sin(a);
+        emitPair(p, halfWidth * glm::vec2(from.x * c - from.y * s, from.x * s + from.y * c));
+    }
+    emitPair(p, halfWidth * to);
+}
+
+void Stroker::emitJoin(int vertex, int inSegment, int outSegment) {
+    glm::vec2 p(px[vertex], py[vertex]);
+    glm::vec2 n0(nx[inSegment], ny[inSegment]);
+    glm::vec2 n1(nx[outSegment], ny[outSegment]);
+    float cosTurn = glm::dot(n0, n1);
+    float sinTurn = n0.x * n1.y - n0.y * n1.x;
+
+    if (cosTurn > 0.9999f) {
+        // Practically straight: one pair along the averaged normal.
+        emitPair(p, halfWidth * glm::normalize(n0 + n1));
+        return;
+    }
+
+    switch (join) {
+    case JoinStyle::Miter: {
+        glm::vec2 bisector = n0 + n1;
+        float len = glm::length(bisector);
+        // 1 / cos(half turn) is the miter length relative to the half width.
+        float miter = len > 1e-6f ? 2.0f / len : miterLimit + 1.0f;
+        if (miter <= miterLimit) {
+            emitPair(p, (halfWidth * miter / len) * bisector);
+            break;
+        }
+        emitPair(p, halfWidth * n0);
+        emitPair(p, halfWidth * n1);
+        break;
+    }
+    case JoinStyle::Bevel:
+        emitPair(p, halfWidth * n0);
+        emitPair(p, halfWidth * n1);
+        break;
+    case JoinStyle::Round:
+        emitArc(p, n0, n1, std::atan2(sinTurn, cosTurn));
+        break;
+    }
+}
+
+void Stroker::emitStartCap(int segment) {
+    glm::vec2 p(px[segment], py[segment]);
+    glm::vec2 d(dx[segment], dy[segment]);
+    glm::vec2 n(nx[segment], ny[segment]);
+
+    switch (cap) {
+    case CapStyle::Butt:
+        emitPair(p, halfWidth * n);
+        break;
+    case CapStyle::Square:
+        emitPair(p - halfWidth * d, halfWidth * n);
+        break;
+    case CapStyle::Round: {
+        // Chords of the half disc, from the tip back to the full width.
+        int steps = 1;
+        if (tolerance < halfWidth)
+            steps = (int)std::ceil(1.5707963f / (2.0f * std::acos(1.0f - tolerance / halfWidth)));
+        for (int k = 0; k <= steps; ++k) {
+            float a = 1.5707963f * (float)k / (float)steps;
+            emitPair(p - (halfWidth * std::cos(a)) * d, (halfWidth * std::sin(a)) * n);
+        }
+        break;
+    }
+    }
+}
+
+void Stroker::emitEndCap(int segment) {
+    glm::vec2 p(px[segment + 1], py[segment + 1]);
+    glm::vec2 d(dx[segment], dy[segment]);
+    glm::vec2 n(nx[segment], ny[segment]);
+
+    switch (cap) {
+    case CapStyle::Butt:
+        emitPair(p, halfWidth * n);
+        break;
+    case CapStyle::Square:
+        emitPair(p + halfWidth * d, halfWidth * n);
+        break;
+    case CapStyle::Round: {
+        int steps = 1;
+        if (tolerance < halfWidth)
+            steps = (int)std::ceil(1.5707963f / (2.0f * std::acos(1.0f - tolerance / halfWidth)));
+        for (int k = steps; k >= 0; --k) {
+            float a = 1.5707963f * (float)k / (float)steps;
+            emitPair(p + (halfWidth * std::cos(a)) * d, (halfWidth * std::sin(a)) * n);
+        }
+        break;
+    }
+    }
+}
@@ -0,0 +1,69 @@
+#ifndef STROKER_HPP
+#define STROKER_HPP
+
+#include <vector>
+#include <glm/glm.hpp>
+#include "FrameArena.hpp"
+
+enum class JoinStyle { Miter, Round, Bevel };
+enum class CapStyle { Butt, Square, Round };
+
+// Turns a polyline in the z = 0 plane into a single GL_TRIANGLE_STRIP of the
+// given width. The output and scratch vectors are reused across calls, so once
+// they have grown to the largest stroke seen no further allocation happens;
+// with setArena() the scratch comes from a frame arena instead.
+// The strip folds back on itself at joins: draw it without face culling.
+// Alongside each vertex the stroker writes an edge coordinate, +1 on the left
+// edge and -1 on the right, for distance-based anti-aliasing in the shader.
+class Stroker {
+public:
+    Stroker();
+
+    // Full stroke width, in world units.
+    void setWidth(float width);
+    void setJoin(JoinStyle join);
+    void setCap(CapStyle cap);
+    // Miter length (as a multiple of half the width) above which a miter join becomes a bevel.
+    void setMiterLimit(float limit);
+    // Maximum distance between a round join/cap arc and its polygon, in world units.
+    void setTolerance(float tolerance);
+    // Scratch memory comes from the arena from the next clear() on. The arena
+    // must not be reset between clear() and the last append().
+    void setArena(FrameArena* arena);
+
+    // Strokes the polyline; closed polylines get a join at the first point instead of caps.
+    const std::vector<glm::vec3>& stroke(const std::vector<glm::vec3>& polyline, bool closed);
+
+    // Build one strip out of several polylines: clear(), then append() each piece.
+    // Pieces are joined by degenerate triangles.
+    void clear();
+    void append(const glm::vec3* points, size_t count, bool closed);
+
+    const std::vector<glm::vec3>& vertices() const { return out; }
+    const std::vector<float>& edgeCoordinates() const { return outEdge; }
+
+private:
+    void emitPair(const glm::vec2& p, const glm::vec2& offset);
+    void emitArc(const glm::vec2& p, const glm::vec2& from, const glm::vec2& to, float angle);
+    void emitJoin(int vertex, int inSegment, int outSegment);
+    void emitStartCap(int segment);
+    void emitEndCap(int segment);
+
+    float halfWidth;
+    JoinStyle join;
+    CapStyle cap;
+    float miterLimit;
+    float tolerance;
+
+    // Scratch, structure-of-arrays: deduplicated points and per-segment direction/normal.
+    FrameArena* arena;
+    ArenaVector<float> px, py;
+    ArenaVector<float> dx, dy;
+    ArenaVector<float> nx, ny;
+
+    std::vector<glm::vec3> out;
+    std::vector<float> outEdge;
+    bool bridgePending; // the next pair starts a new piece of a non-empty strip
+};
+
+#endif // STROKER_HPP
@@ -0,0 +1,103 @@
+#include "Tessellator.hpp"
+
+namespace {
+
+CubicSegment makeSegment(const std::vector<glm::vec3>& points, int i) {
+    int n = (int)points.size();
+    const glm::vec3& prev = points[(i + n - 1) % n];
+    const glm::vec3& a = points[i];
+    const glm::vec3& b = points[(i + 1) % n];
+    const glm::vec3& next = points[(i + 2) % n];
+
+    CubicSegment s;
+    s.p[0] = a;
+    s.p[1] = a + (b - prev) / 6.0f;
+    s.p[2] = b - (next - a) / 6.0f;
+    s.p[3] = b;
+    return s;
+}
+
+} // namespace
+
+void buildClosedCurve(const std::vector<glm::vec3>& points, std::vector<CubicSegment>& segments) {
+    segments.resize(points.size());
+    for (int i = 0; i < (int)points.size(); ++i)
+        segments[i] = makeSegment(points, i);
+}
+
+void updateClosedCurve(const std::vector<glm::vec3>& points, int index, std::vector<CubicSegment>& segments) {
+    int n = (int)points.size();
+    if (index < 0 || index >= n || (int)segments.size() != n)
+        return;
+    for (int k = -2; k <= 1; ++k) {
+        int i = ((index + k) % n + n) % n;
+        segments[i] = makeSegment(points, i);
+    }
+}
+
+glm::vec3 evaluateSegment(const CubicSegment& segment, float t) {
+    float u = 1.0f - t;
+    float b0 = u * u * u;
+    float b1 = 3.0f * u * u * t;
+    float b2 = 3.0f * u * t * t;
+    float b3 = t * t * t;
+    return b0 * segment.p[0] + b1 * segment.p[1] + b2 * segment.p[2] + b3 * segment.p[3];
+}
+
+void tessellateSegment(const CubicSegment& segment, int steps, bool skipFirst, std::vector<glm::vec3>& out) {
+    if (steps < 1) steps = 1;
+    size_t first = out.size();
+    out.resize(first + steps + (skipFirst ? 0 : 1));
+    tessellateSegment(segment, steps, skipFirst, false, out.data() + first);
+}
+
+glm::vec3* tessellateSegment(const CubicSegment& segment, int steps, bool skipFirst, bool skipLast, glm::vec3* out) {
+    if (steps < 1) steps = 1;
+    int last = skipLast ? steps - 1 : steps;
+    for (int i = skipFirst ? 1 : 0; i <= last; ++i)
+        *out++ = evaluateSegment(segment, (float)i / (float)steps);
+    return out;
+}
+
+void tessellateCurve(const std::vector<CubicSegment>& segments, int steps, bool closed, std::vector<glm::vec3>& out) {
+    out.clear();
+    for (size_t i = 0; i < segments.size(); ++i)
+        tessellateSegment(segments[i], steps, i > 0, out);
+    if (closed && out.size() > 1)
+        out.pop_back();
+}
+
+size_t tessellatedCurveSize(size_t segmentCount, int steps, bool closed) {
+    if (segmentCount == 0)
+        return 0;
+    size_t samples = segmentCount * (size_t)glm::max(steps, 1) + 1;
+    return closed ? samples - 1 : samples;
+}
+
+void tessellateCurves(const std::vector<std::vector<glm::vec3> >& curves, int steps, bool closed,
+                      std::vector<glm::vec3>& out, std::vector<PolylineRun>& runs) {
+    // Segments are built on the fly and samples written in place: no scratch, so
+    // once out and runs have grown to the largest scene nothing is allocated.
+    out.clear();
+    runs.clear();
+    for (size_t c = 0; c < curves.size(); ++c) {
+        const std::vector<glm::vec3>& points = curves[c];
+        int n = (int)points.size();
+        PolylineRun run;
+        run.first = (int)out.size();
+        run.count = (int)tessellatedCurveSize(points.size(), steps, closed);
+        run.closed = closed && run.count > 1;
+        runs.push_back(run);
+        out.resize(out.size() + run.count);
+        glm::vec3* samples = out.data() + run.first;
+        for (int i = 0; i < n; ++i)
+            samples = tessellateSegment(makeSegment(points, i), steps, i > 0, closed && i + 1 == n, samples);
+    }
+}
+
+void tessellateDrawList(const std::vector<CubicSegment>& segments, const std::vector<SegmentDraw>& drawList, bool closed,
+                        std::vector<glm::vec3>& out, std::vector<PolylineRun>& runs) {
+    buildRuns(drawList, (int)segments.size(), closed, out, runs, [&](int item, bool skipFirst) {
+        tessellateSegment(segments[drawList[item].segment], drawList[item].steps, skipFirst, out);
+    });
+}
@@ -0,0 +1,119 @@
+#ifndef TESSELLATOR_HPP
+#define TESSELLATOR_HPP
+
+#include <vector>
+#include <glm/glm.hpp>
+
+// One cubic Bezier piece: p[0] and p[3] are on the curve, p[1] and p[2] are handles.
+struct CubicSegment {
+    glm::vec3 p[4];
+};
+
+// One entry of a draw list: which segment to tessellate and how finely.
+struct SegmentDraw {
+    int segment;
+    int steps;
+};
+
+inline bool operator==(const SegmentDraw& a, const SegmentDraw& b) {
+    return a.segment == b.segment && a.steps == b.steps;
+}
+
+// A contiguous piece of a tessellated polyline: vertices [first, first + count).
+// A closed run continues from its last vertex back to its first.
+struct PolylineRun {
+    int first;
+    int count;
+    bool closed;
+};
+
+// Builds a closed, C1 piecewise-cubic Bezier through every point, one segment per
+// point. Handles follow Catmull-Rom tangents: (P[i+1] - P[i-1]) / 6.
+void buildClosedCurve(const std::vector<glm::vec3>& points, std::vector<CubicSegment>& segments);
+
+// Rebuilds only the segments whose control points depend on points[index]
+// (segments index-2 .. index+1, wrapping around).
+void updateClosedCurve(const std::vector<glm::vec3>& points, int index, std::vector<CubicSegment>& segments);
+
+// Point on the segment at parameter t.
+glm::vec3 evaluateSegment(const CubicSegment& segment, float t);
+
+// Appends steps + 1 samples (t = 0 .. 1) of the segment, or steps samples when
+// skipFirst is set so consecutive segments do not repeat their shared end point.
+void tessellateSegment(const CubicSegment& segment, int steps, bool skipFirst, std::vector<glm::vec3>& out);
+// Same samples written to out, also leaving out the t = 1 sample when skipLast
+// is set; returns the end of what was written.
+glm::vec3* tessellateSegment(const CubicSegment& segment, int steps, bool skipFirst, bool skipLast, glm::vec3* out);
+
+// Tessellates every segment with the same step count into one polyline. For a
+// closed curve the last sample equals the first and is dropped.
+void tessellateCurve(const std::vector<CubicSegment>& segments, int steps, bool closed, std::vector<glm::vec3>& out);
+
+// Number of vertices tessellateCurve gives for a curve of segmentCount segments.
+size_t tessellatedCurveSize(size_t segmentCount, int steps, bool closed);
+
+// Many curves, each given by its points as for buildClosedCurve, into one
+// vertex array with one run per curve, in curve order. The serial reference
+// for ParallelTessellator::tessellate; p2_bench checks at startup that both
+// give the same bits.
+void tessellateCurves(const std::vector<std::vector<glm::vec3> >& curves, int steps, bool closed,
+                      std::vector<glm::vec3>& out, std::vector<PolylineRun>& runs);
+
+// Walks a draw list (ascending segment order) and groups it into runs of
+// consecutive segments, wrapping around for closed curves. emit(item, skipFirst)
+// must append the samples of drawList[item] to out. A list holding every
+// segment of a closed curve gives a single closed run.
+template <typename Emit>
+void buildRuns(const std::vector<SegmentDraw>& drawList, int segmentCount, bool closed,
+               std::vector<glm::vec3>& out, std::vector<PolylineRun>& runs, Emit emit) {
+    out.clear();
+    runs.clear();
+    int n = segmentCount;
+    int m = (int)drawList.size();
+    if (m == 0)
+        return;
+
+    // Start where the previous entry is not the previous segment, so wrapped runs stay whole.
+    int start = 0;
+    if (closed && m < n) {
+        for (int i = 0; i < m; ++i) {
+            int prev = drawList[(i + m - 1) % m].segment;
+            if (prev != (drawList[i].segment + n - 1) % n) {
+                start = i;
+                break;
+            }
+        }
+    }
+
+    int prevSegment = -1;
+    for (int k = 0; k < m; ++k) {
+        int item = (start + k) % m;
+        int segment = drawList[item].segment;
+        bool continues = prevSegment >= 0 && segment == (prevSegment + 1) % n;
+        if (!continues) {
+            PolylineRun run;
+            run.first = (int)out.size();
+            run.count = 0;
+            run.closed = false;
+            runs.push_back(run);
+        }
+        emit(item, continues);
+        runs.back().count = (int)out.size() - runs.back().first;
+        prevSegment = segment;
+    }
+
+    if (closed && m == n && runs.size() == 1 && runs[0].count > 1) {
+        out.pop_back();
+        runs[0].count--;
+        runs[0].closed = true;
+    }
+}
+
+// Tessellates the segments of a draw list (ascending segment order) into one
+// vertex array. Consecutive segments share a run; a gap starts a new one. For a
+// closed curve the runs wrap around, and a list holding every segment gives a
+// single closed run.
+void tessellateDrawList(const std::vector<CubicSegment>& segments, const std::vector<SegmentDraw>& drawList, bool closed,
+                        std::vector<glm::vec3>& out, std::vector<PolylineRun>& runs);
+
+#endif // TESSELLATOR_HPP
@@ -0,0 +1,135 @@
+#include "Trace.hpp"
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Trace {
+
+std::atomic<bool> enabledFlag(false);
+
+namespace {
+
+struct Event {
+    const char* name;
+    uint64_t begin, end;
+};
+
+// Written only by its thread; count is published with release so the
+// exporter reads complete events.
+struct ThreadBuffer {
+    static const size_t kCapacity = 1 << 16;
+
+    int id;
+    const char* name;
+    std::vector<Event> events;
+    std::atomic<size_t> count;
+    std::atomic<size_t> dropped;
+
+    ThreadBuffer(int id) : id(id), name(nullptr), events(kCapacity), count(0), dropped(0) {}
+};
+
+std::mutex registryMutex;
+std::vector<std::unique_ptr<ThreadBuffer> >& registry() {
+    static std::vector<std::unique_ptr<ThreadBuffer> > buffers;
+    return buffers;
+}
+
+std::chrono::steady_clock::time_point startTime() {
+    static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    return start;
+}
+
+// The calling thread's buffer, registered on first use; buffers live until exit.
+ThreadBuffer& localBuffer() {
+    thread_local ThreadBuffer* buffer = nullptr;
+    if (!buffer) {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        std::vector<std::unique_ptr<ThreadBuffer> >& buffers = registry();
+        buffers.push_back(std::unique_ptr<ThreadBuffer>(new ThreadBuffer((int)buffers.size() + 1)));
+        buffer = buffers.back().get();
+    }
+    return *buffer;
+}
+
+// Names are literals from our own code, but keep the JSON valid regardless.
+void writeString(FILE* file, const char* text) {
+    fputc('"', file);
+    for (const char* c = text; *c; ++c) {
+        if (*c == '"' || *c == '\\')
+            fputc('\\', file);
+        if ((unsigned char)*c >= 0x20)
+            fputc(*c, file);
+    }
+    fputc('"', file);
+}
+
+} // namespace
+
+void setEnabled(bool enabled) {
+    startTime();
+    enabledFlag.store(enabled, std::memory_order_relaxed);
+}
+
+// Only while enabled, so untraced runs allocate no buffers.
+void setThreadName(const char* name) {
+    if (enabled())
+        localBuffer().name = name;
+}
+
+uint64_t now() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime()).count();
+}
+
+void record(const char* name, uint64_t begin, uint64_t end) {
+    ThreadBuffer& buffer = localBuffer();
+    size_t n = buffer.count.load(std::memory_order_relaxed);
+    if (n == ThreadBuffer::kCapacity) {
+        buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    Event& event = buffer.events[n];
+    event.name = name;
+    event.begin = begin;
+    event.end = end;
+    buffer.count.store(n + 1, std::memory_order_release);
+}
+
+bool writeJson(const std::string& path) {
+    FILE* file = fopen(path.c_str(), "w");
+    if (!file) {
+        fprintf(stderr, "Could not write trace to %s\n", path.c_str());
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(registryMutex);
+    std::vector<std::unique_ptr<ThreadBuffer> >& buffers = registry();
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    bool first = true;
+    for (size_t b = 0; b < buffers.size(); ++b) {
+        ThreadBuffer& buffer = *buffers[b];
+        if (buffer.name) {
+            fprintf(file, "%s{\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"name\":\"thread_name\",\"args\":{\"name\":", first ? "" : ",\n", buffer.id);
+            writeString(file, buffer.name);
+            fprintf(file, "}}");
+            first = false;
+        }
+        size_t n = buffer.count.load(std::memory_order_acquire);
+        for (size_t i = 0; i < n; ++i) {
+            const Event& event = buffer.events[i];
+            // Microseconds, as the format expects.
+            fprintf(file, "%s{\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"name\":", first ? "" : ",\n", buffer.id);
+            writeString(file, event.name);
+            fprintf(file, ",\"ts\":%.3f,\"dur\":%.3f}", event.begin * 1e-3, (event.end - event.begin) * 1e-3);
+            first = false;
+        }
+        size_t dropped = buffer.dropped.load(std::memory_order_relaxed);
+        if (dropped > 0)
+            fprintf(stderr, "Trace buffer of thread %d was full, %zu events dropped\n", buffer.id, dropped);
+    }
+    fprintf(file, "\n]}\n");
+    fclose(file);
+    return true;
+}
+
+} // namespace Trace
@@ -0,0 +1,63 @@
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// Timeline tracing in the Chrome trace-event format (chrome://tracing,
+// ui.perfetto.dev). Each thread records complete begin/end events into its own
+// fixed-size buffer, so recording takes no lock and never allocates; the
+// buffers are registered once per thread and written out by writeJson().
+//
+// Two switches: builds without P2_TRACING compile every TRACE_* macro to
+// nothing, and with it the macros cost one relaxed load until
+// Trace::setEnabled(true) (main.cpp: --trace <path>). Event and thread names
+// must outlive the trace; string literals do.
+namespace Trace {
+
+void setEnabled(bool enabled);
+// Labels the calling thread's row; no-op while tracing is off.
+void setThreadName(const char* name);
+
+// Nanoseconds since the process started tracing.
+uint64_t now();
+// Adds a complete event for the calling thread.
+void record(const char* name, uint64_t begin, uint64_t end);
+
+// Events recorded so far by every thread; run it once the other threads are quiet.
+bool writeJson(const std::string& path);
+
+extern std::atomic<bool> enabledFlag;
+
+inline bool enabled() {
+    return enabledFlag.load(std::memory_order_relaxed);
+}
+
+// Records the enclosing scope when tracing was on at its start.
+class Scope {
+public:
+    explicit Scope(const char* name) : name(enabled() ? name : nullptr), begin(this->name ? now() : 0) {}
+    ~Scope() {
+        if (name)
+            record(name, begin, now());
+    }
+
+private:
+    const char* name;
+    uint64_t begin;
+};
+
+} // namespace Trace
+
+#ifdef P2_TRACING
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(name) Trace::Scope TRACE_CONCAT(traceScope, __LINE__)(name)
+#define TRACE_THREAD_NAME(name) Trace::setThreadName(name)
+#else
+#define TRACE_SCOPE(name) ((void)0)
+#define TRACE_THREAD_NAME(name) ((void)0)
+#endif
+
+#endif // TRACE_HPP
@@ -0,0 +1,42 @@
+#ifndef TRIPLEBUFFER_HPP
+#define TRIPLEBUFFER_HPP
+
+#include <atomic>
+
+// Lock-free handoff of whole values from one writer thread to one reader
+// thread. The writer fills its private slot and publishes it by swapping it
+// with the shared middle slot; the reader swaps the middle slot with its own
+// when it holds something newer. Neither side ever waits, and the reader always
+// sees the latest published value; older unread ones are overwritten.
+// The writer's slot keeps whatever it held before, so the writer must fully
+// rewrite it each time (vectors keep their capacity, so this does not allocate).
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() : middle(1), back(0), front(2) {}
+
+    // Writer side.
+    T& writeSlot() { return slots[back]; }
+    void publish() { back = middle.exchange(back | kFresh, std::memory_order_acq_rel) & kIndexMask; }
+
+    // Reader side. acquire() returns false and keeps the current slot when nothing new was published.
+    bool hasFresh() const { return (middle.load(std::memory_order_acquire) & kFresh) != 0; }
+    bool acquire() {
+        if (!hasFresh())
+            return false;
+        front = middle.exchange(front, std::memory_order_acq_rel) & kIndexMask;
+        return true;
+    }
+    const T& readSlot() const { return slots[front]; }
+
+private:
+    static const unsigned kIndexMask = 3;
+    static const unsigned kFresh = 4;
+
+    T slots[3];
+    std::atomic<unsigned> middle; // slot index, plus kFresh when the reader has not taken it yet
+    unsigned back;                // writer only
+    unsigned front;               // reader only
+};
+
+#endif // TRIPLEBUFFER_HPP
@@ -0,0 +1,28 @@
+#ifndef UPLOADSTATS_HPP
+#define UPLOADSTATS_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Running total of the bytes the GL objects hand to glBufferData and
+// glBufferSubData with data attached (allocations without data are not
+// counted). Read it before and after a frame to get that frame's upload size.
+namespace UploadStats {
+
+inline std::atomic<uint64_t>& counter() {
+    static std::atomic<uint64_t> bytes(0);
+    return bytes;
+}
+
+inline void add(size_t bytes) {
+    counter().fetch_add(bytes, std::memory_order_relaxed);
+}
+
+inline uint64_t total() {
+    return counter().load(std::memory_order_relaxed);
+}
+
+} // namespace UploadStats
+
+#endif // UPLOADSTATS_HPP
@@ -0,0 +1,67 @@
+#include "VertexFormat.hpp"
+#include <cmath>
+#include <cstring>
+
+void VertexFormat::apply() const {
+    for (int i = 0; i < attributeCount; ++i) {
+        const VertexAttribute& a = attributes[i];
+        glVertexAttribPointer(a.location, a.components, a.type, a.normalized, stride, (void*)(uintptr_t)a.offset);
+        glEnableVertexAttribArray(a.location);
+    }
+}
+
+VertexFormat pointVertexFormat(PositionFormat positions) {
+    VertexFormat format;
+    format.attributeCount = 2;
+    if (positions == PositionFormat::Quantized16) {
+        format.attributes[0] = { 0, 2, GL_UNSIGNED_SHORT, GL_TRUE, 0 }; // z reads as 0
+        format.attributes[1] = { 1, 4, GL_UNSIGNED_BYTE, GL_TRUE, 4 };
+        format.stride = 8;
+    } else if (positions == PositionFormat::Half) {
+        format.attributes[0] = { 0, 3, GL_HALF_FLOAT, GL_FALSE, 0 };
+        format.attributes[1] = { 1, 4, GL_UNSIGNED_BYTE, GL_TRUE, 8 };
+        format.stride = 12;
+    } else {
+        format.attributes[0] = { 0, 3, GL_FLOAT, GL_FALSE, 0 };
+        format.attributes[1] = { 1, 4, GL_UNSIGNED_BYTE, GL_TRUE, 12 };
+        format.stride = 16;
+    }
+    return format;
+}
+
+// packHalf2x16 and packUnorm4x8 put the first component in the low bits,
+// which lands it first in memory on little-endian hosts.
+void packPointVertex(PositionFormat positions, const glm::vec3& position, const glm::vec3& color, unsigned char* out,
+                     const glm::dvec2& tileOrigin, double tileSize) {
+    uint32_t rgba = glm::packUnorm4x8(glm::vec4(color, 1.0f));
+    if (positions == PositionFormat::Quantized16) {
+        uint16_t q[2];
+        for (int axis = 0; axis < 2; ++axis) {
+            double t = ((double)position[axis] - tileOrigin[axis]) / tileSize;
+            q[axis] = (uint16_t)glm::clamp(std::floor(t * 65535.0 + 0.5), 0.0, 65535.0);
+        }
+        memcpy(out, q, 4);
+        memcpy(out + 4, &rgba, 4);
+    } else if (positions == PositionFormat::Half) {
+        uint32_t xy = glm::packHalf2x16(glm::vec2(position.x, position.y));
+        uint32_t zw = glm::packHalf2x16(glm::vec2(position.z, 1.0f));
+        memcpy(out, &xy, 4);
+        memcpy(out + 4, &zw, 4);
+        memcpy(out + 8, &rgba, 4);
+    } else {
+        memcpy(out, &position, 12);
+        memcpy(out + 12, &rgba, 4);
+    }
+}
+
+glm::dvec2 tileOriginOf(const glm::vec3& position, double tileSize) {
+    return glm::dvec2(std::floor((double)position.x / tileSize), std::floor((double)position.y / tileSize)) * tileSize;
+}
+
+glm::mat4 tileMatrix(const glm::mat4& projection, const glm::mat4& view, const glm::dvec2& tileOrigin, double tileSize) {
+    glm::dmat4 tile(1.0);
+    tile[0][0] = tileSize;
+    tile[1][1] = tileSize;
+    tile[3] = glm::dvec4(tileOrigin, 0.0, 1.0);
+    return glm::mat4(glm::dmat4(projection) * glm::dmat4(view) * tile);
+}
@@ -0,0 +1,55 @@
+#ifndef VERTEXFORMAT_HPP
+#define VERTEXFORMAT_HPP
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <GL/glew.h>
+
+// Layout of one interleaved vertex: which attribute locations it feeds, with
+// what type, at what offset. apply() points the bound VAO at the bound
+// GL_ARRAY_BUFFER accordingly. Packed types are read through the usual float
+// attributes (half floats as is, bytes normalized), so shaders written for
+// plain vec3 inputs draw any format unchanged.
+struct VertexAttribute {
+    GLuint location;
+    GLint components;
+    GLenum type;
+    GLboolean normalized;
+    GLuint offset;
+};
+
+struct VertexFormat {
+    static const int kMaxAttributes = 4;
+
+    GLsizei stride;
+    int attributeCount;
+    VertexAttribute attributes[kMaxAttributes];
+
+    void apply() const;
+};
+
+// Control point vertices: position at location 0, color at location 1.
+//   Float:       3 x f32 position, RGBA8 color          16 bytes
+//   Half:        4 x f16 position (w unused), RGBA8      12 bytes
+//   Quantized16: 2 x unorm16 tile-relative x, y, RGBA8    8 bytes
+// against 24 for separate float vec3 buffers. Half positions keep 11
+// significant bits, about 1e-3 of the coordinate's magnitude.
+//
+// Quantized16 is for planar drawings (z = 0) of any extent: a point is stored
+// as its offset in a square tile of the plane, in steps of tileSize / 65535,
+// and the shader sees (x, y) in [0, 1]. The draw call folds the tile's origin
+// and size into the MVP matrix (tileMatrix()), computed in double precision,
+// so the shader dequantizes without ever holding a large coordinate in float.
+enum class PositionFormat { Float, Half, Quantized16 };
+
+VertexFormat pointVertexFormat(PositionFormat positions);
+// Writes one vertex of the format at out, stride bytes. The tile only matters for Quantized16.
+void packPointVertex(PositionFormat positions, const glm::vec3& position, const glm::vec3& color, unsigned char* out,
+                     const glm::dvec2& tileOrigin = glm::dvec2(0.0), double tileSize = 1.0);
+
+// Origin of the tile of the given size holding the point: a multiple of tileSize.
+glm::dvec2 tileOriginOf(const glm::vec3& position, double tileSize);
+// projection * view * (tile's unit square -> world), evaluated in double.
+glm::mat4 tileMatrix(const glm::mat4& projection, const glm::mat4& view, const glm::dvec2& tileOrigin, double tileSize);
+
+#endif // VERTEXFORMAT_HPP
@@ -0,0 +1,33 @@
+#version 330 core
+
+// Loop-Blinn: the curve is k^3 - l*m = 0, the filled side is negative.
+in vec3 klmCoord;
+
+uniform vec3 fillColor;
+uniform bool stencilPass; // hard inside/outside test, for writing the stencil and the cover
+
+out vec4 finalColor;
+
+void main() {
+    float k = klmCoord.x, l = klmCoord.y, m = klmCoord.z;
+    float f = k * k * k - l * m;
+    if (stencilPass) {
+        if (f > 0.0)
+            discard;
+        finalColor = vec4(fillColor, 1.0);
+        return;
+    }
+    // Edge pass, run only on pixels the stencil left outside the fill: the
+    // fill lies across the curve, so the covered fraction is how far the
+    // curve reaches past the pixel centre, whichever side of it is filled.
+    // First-order distance in pixels: f / |grad f|, with the gradient from
+    // the chain rule on the interpolated klm.
+    vec3 dx = dFdx(klmCoord), dy = dFdy(klmCoord);
+    vec2 grad = vec2(3.0 * k * k * dx.x - m * dx.y - l * dx.z,
+                     3.0 * k * k * dy.x - m * dy.y - l * dy.z);
+    float dist = abs(f) / max(length(grad), 1e-8);
+    float coverage = clamp(0.5 - dist, 0.0, 1.0);
+    if (coverage <= 0.0)
+        discard;
+    finalColor = vec4(fillColor, coverage);
+}
@@ -0,0 +1,13 @@
+#version 330 core
+
+layout(location = 0) in vec3 position;
+layout(location = 1) in vec3 klm;
+
+uniform mat4 MVP;
+
+out vec3 klmCoord;
+
+void main() {
+    gl_Position = MVP * vec4(position, 1.0);
+    klmCoord = klm;
+}
@@ -0,0 +1,20 @@
+#version 330 core
+
+flat in vec2 segA;
+flat in vec2 segB;
+
+uniform float halfWidth;
+uniform vec3 lineColor;
+
+out vec4 finalColor;
+
+void main() {
+    // Coverage of the capsule around the segment from the pixel's distance to it;
+    // neighbouring capsules overlap into round joins.
+    vec2 ab = segB - segA;
+    float t = clamp(dot(gl_FragCoord.xy - segA, ab) / max(dot(ab, ab), 1e-6), 0.0, 1.0);
+    float coverage = clamp(halfWidth - distance(gl_FragCoord.xy, segA + ab * t) + 0.5, 0.0, 1.0);
+    if (coverage <= 0.0)
+        discard;
+    finalColor = vec4(lineColor, coverage);
+}
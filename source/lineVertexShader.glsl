@@ -0,0 +1,37 @@
+#version 330 core
+
+// One instance per segment; the four strip corners come from gl_VertexID.
+layout(location = 0) in vec3 pointA;
+layout(location = 1) in vec3 pointB;
+
+uniform mat4 MVP;
+uniform vec2 viewportSize;
+uniform float halfWidth; // in pixels
+
+flat out vec2 segA; // segment end points in window coordinates
+flat out vec2 segB;
+
+void main() {
+    vec4 clipA = MVP * vec4(pointA, 1.0);
+    vec4 clipB = MVP * vec4(pointB, 1.0);
+    vec2 a = (clipA.xy / clipA.w * 0.5 + 0.5) * viewportSize;
+    vec2 b = (clipB.xy / clipB.w * 0.5 + 0.5) * viewportSize;
+
+    vec2 dir = b - a;
+    float len = length(dir);
+    dir = len > 1e-6 ? dir / len : vec2(1.0, 0.0);
+    vec2 normal = vec2(-dir.y, dir.x);
+
+    // Corners in strip order: A left, A right, B left, B right (counter-clockwise).
+    bool atB = gl_VertexID >= 2;
+    float side = (gl_VertexID & 1) == 0 ? 1.0 : -1.0;
+    // One extra pixel all round for the anti-aliased rim.
+    float extent = halfWidth + 1.0;
+    vec2 corner = atB ? b + dir * extent : a - dir * extent;
+    corner += normal * side * extent;
+
+    segA = a;
+    segB = b;
+    float depth = atB ? clipB.z / clipB.w : clipA.z / clipA.w;
+    gl_Position = vec4(corner / viewportSize * 2.0 - 1.0, depth, 1.0);
+}
@@ -3,14 +3,41 @@
 #include <GLFW/glfw3.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include "AllocationCounter.hpp"
+#include "CurveWorker.hpp"
+#include "FillObject.hpp"
+#include "FrameArena.hpp"
+#include "FrameProfiler.hpp"
+#include "FrameScheduler.hpp"
+#include "InputLog.hpp"
+#include "InputQueue.hpp"
+#include "LatencyTracker.hpp"
+#include "LineObject.hpp"
 #include "PointsObject.hpp"
+#include "SceneArchive.hpp"
+#include "SceneFile.hpp"
+#include "StrokeObject.hpp"
+#include "Trace.hpp"
 
 // Function prototypes
 int initWindow(void);
 static void mouseCallback(GLFWwindow*, int, int, int);
-int getPickedIndex();
-glm::vec3 getWorldPosition(const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix);
+static void keyCallback(GLFWwindow*, int, int, int, int);
+static void scrollCallback(GLFWwindow*, double, double);
+static void cursorPosCallback(GLFWwindow*, double, double);
+static void windowRefreshCallback(GLFWwindow*);
+static void windowSizeCallback(GLFWwindow*, int, int);
+static void windowFocusCallback(GLFWwindow*, int);
+int getPickedIndex(double x_pos, double y_pos);
+glm::vec3 getWorldPosition(double x_pos, double y_pos, const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix);
+void processInput();
+void handleEvent(const InputEvent& event);
+void submitCurve();
+bool presentCurve();
+glm::mat4 computeProjection();
 
 const GLuint windowWidth = 1024, windowHeight = 768;
 GLFWwindow* window;
@@ -23,16 +50,124 @@ std::vector<glm::vec3> colors; // Vector to hold the colors
 glm::vec3 storedColor; // Used to restore a point to its original color after picking color is drawn
 int storedIndex;
 PointsObject* pointsObj;
+// --half-points packs positions as half floats, --quantized-points <tile size>
+// as 16-bit offsets in tiles of that many world units.
+PositionFormat pointPositions = PositionFormat::Float;
+double pointTileSize = 1.0;
+// --scene <path> starts from the first curve of a scene file or archive
+// instead of the eight default points; --save-scene <path> writes the curve
+// there, uncompressed, on exit.
+std::string scenePath, saveScenePath;
 
-int main() {
+// View: scroll to zoom around the cursor, drag with the right button to pan.
+const float viewHalfWidth = 4.0f, viewHalfHeight = 3.0f; // world units visible at zoom 1
+glm::vec2 viewCenter(0.0f, 0.0f);
+float viewZoom = 1.0f;
+float worldPerPixel = 2.0f * viewHalfWidth / windowWidth;
+bool panning = false;
+double panLastX, panLastY;
+
+// The closed Bezier curve through the points and its stroke. The curve worker
+// thread culls, tessellates and strokes it; only visible segments are
+// tessellated, each at a step count picked from its on-screen size, and
+// refinement beyond a coarse first pass is capped per pass.
+const float strokeWidthPixels = 4.0f;
+const double refineBudgetMs = 4.0;
+CurveWorker curveWorker;
+std::vector<uint32_t> fillRevisions; // segment revisions the fill was last uploaded with
+bool curveDirty = true; // points, view or draw mode changed since the last submit
+StrokeObject* strokeObj;
+LineObject* lineObj;
+bool useGpuLines = true; // 'L' toggles between GPU instanced lines and the CPU stroker
+FillObject* fillObj; // 'F' toggles between non-zero and even-odd filling
+FrameArena frameArena; // render-thread scratch, reset after every drawn frame
+
+// Frames are drawn only when something changed; 'C' or --continuous redraws every frame.
+FrameScheduler frameScheduler;
+
+// Per-phase CPU and GPU timings, written as JSON on exit (--profile <path>).
+FrameProfiler profiler;
+std::string profilePath = "frame_profile.json";
+std::string tracePath; // --trace <path>: record a Chrome trace and write it there on exit
+// --alloc-check <frames>: after that many warm-up frames, fail on the first frame
+// that allocates (needs P2_COUNT_ALLOCATIONS). Runs continuously.
+int allocationCheckWarmup = -1;
+bool allocationCheckFailed = false;
+
+// Input-to-photon latency of every point drag, written as JSON on exit (--latency <path>).
+LatencyTracker latency;
+std::string latencyPath = "drag_latency.json";
+uint64_t curveSequence = 0; // numbers the inputs submitted to the curve worker
+
+// The GLFW callbacks only queue events; processInput() handles all of them
+// before each frame, in order, so fast drags are not sampled at frame rate.
+InputQueue inputQueue;
+double cursorX = windowWidth / 2, cursorY = windowHeight / 2; // as of the last processed event
+
+// --record <path> logs every handled event; --replay <path> feeds a log back
+// in place of live input, one recorded frame per drawn frame, as fast as the
+// frames draw, and closes the window at the end. ESC still stops a replay.
+InputRecorder inputRecorder;
+InputReplayer inputReplayer;
+uint32_t inputFrame = 0; // frames drawn so far
+double inputFrameStart = 0.0; // when the last frame was presented
+
+int main(int argc, char** argv) {
     // ATTN: REFER TO https://learnopengl.com/Getting-started/Creating-a-window
     // AND https://learnopengl.com/Getting-started/Hello-Window to familiarize yourself with the initialization of a window in OpenGL
     
     if (initWindow() != 0) return -1;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--continuous") == 0)
+            frameScheduler.setMode(FrameScheduler::Mode::Continuous);
+        else if (strcmp(argv[i], "--profile") == 0 && i + 1 < argc)
+            profilePath = argv[++i];
+        else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+            tracePath = argv[++i];
+        else if (strcmp(argv[i], "--alloc-check") == 0 && i + 1 < argc)
+            allocationCheckWarmup = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--latency") == 0 && i + 1 < argc)
+            latencyPath = argv[++i];
+        else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+            inputRecorder.open(argv[++i], windowWidth, windowHeight);
+        else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc)
+            inputReplayer.open(argv[++i]);
+        else if (strcmp(argv[i], "--scene") == 0 && i + 1 < argc)
+            scenePath = argv[++i];
+        else if (strcmp(argv[i], "--save-scene") == 0 && i + 1 < argc)
+            saveScenePath = argv[++i];
+        else if (strcmp(argv[i], "--half-points") == 0)
+            pointPositions = PositionFormat::Half;
+        else if (strcmp(argv[i], "--quantized-points") == 0 && i + 1 < argc && atof(argv[i + 1]) > 0.0) {
+            pointPositions = PositionFormat::Quantized16;
+            pointTileSize = atof(argv[++i]);
+        }
+    }
+    if (allocationCheckWarmup >= 0) {
+        if (AllocationCounter::compiledIn()) {
+            frameScheduler.setMode(FrameScheduler::Mode::Continuous);
+        } else {
+            fprintf(stderr, "--alloc-check ignored: built without P2_COUNT_ALLOCATIONS\n");
+            allocationCheckWarmup = -1;
+        }
+    }
+    if (inputReplayer.isOpen()) {
+        inputRecorder.close(); // a replay records nothing new
+        glfwSetWindowSize(window, inputReplayer.windowWidth(), inputReplayer.windowHeight());
+        frameScheduler.setMode(FrameScheduler::Mode::Continuous);
+        printf("Replaying %u frames of input\n", inputReplayer.frameCount());
+    }
+    if (!tracePath.empty()) {
+#ifdef P2_TRACING
+        Trace::setEnabled(true);
+        TRACE_THREAD_NAME("main");
+#else
+        fprintf(stderr, "--trace ignored: built without P2_TRACING\n");
+        tracePath.clear();
+#endif
+    }
 
 
-    glm::mat4 projectionMatrix = glm::ortho(-4.0f, 4.0f, -3.0f, 3.0f, 0.0f, 100.0f); // In world coordinates
-
     std::vector<glm::vec3> colors;
     glm::vec3 generatedColor;
     for (int i = 0; i < 8; ++i) {
@@ -51,63 +186,166 @@ int main() {
     colors.push_back(glm::vec3(0.0f, 1.0f, 1.0f)); // Default color (cyan)
     colors.push_back(glm::vec3(0.0f, 1.0f, 0.0f)); // Default color (green)--
     colors.push_back(glm::vec3(1.0f, 0.5f, 0.0f)); // Default color (orange)
+
+    if (!scenePath.empty()) {
+        SceneFile scene;
+        SceneArchive archive;
+        bool loaded;
+        if (SceneArchive::isArchive(scenePath))
+            loaded = archive.open(scenePath) && archive.curveCount() > 0 && archive.curve(0).pointCount >= 3 && archive.loadCurve(0, nullptr);
+        else
+            loaded = scene.open(scenePath) && scene.curveCount() > 0 && scene.curve(0).pointCount >= 3;
+        if (loaded) {
+            points.clear();
+            colors.clear();
+            if (archive.isOpen())
+                archive.curvePoints(0, points, colors);
+            else
+                scene.curvePoints(0, points, colors);
+            printf("Loaded %zu points from %s\n", points.size(), scenePath.c_str());
+        } else {
+            fprintf(stderr, "%s: no curve of at least 3 points, keeping the default one\n", scenePath.c_str());
+        }
+    }
     
     //TODO: P2aTask1 - Display 8 points on the screen each of a different color and arranged uniformly on a circle.
-    pointsObj = new PointsObject(points, colors);
+    pointsObj = new PointsObject(points, colors, pointPositions, pointTileSize);
+
+    strokeObj = new StrokeObject(glm::vec3(1.0f, 1.0f, 1.0f));
+    lineObj = new LineObject(glm::vec3(1.0f, 1.0f, 1.0f), strokeWidthPixels);
+    lineObj->setScratchArena(&frameArena);
+    fillObj = new FillObject(glm::vec3(0.2f, 0.3f, 0.6f));
+    curveWorker.setRefineBudget(refineBudgetMs);
+    curveWorker.start();
     
+    const int inputPhase = profiler.cpuPhase("input");
+    const int submitPhase = profiler.cpuPhase("submit");
+    const int presentPhase = profiler.cpuPhase("present");
+    const int drawPhase = profiler.cpuPhase("draw");
+    const int swapPhase = profiler.cpuPhase("swap");
+    const int workerPhase = profiler.cpuPhase("worker_pass");
+    const int fillPass = profiler.gpuPass("fill");
+    const int curvePass = profiler.gpuPass("curve");
+    const int pointsPass = profiler.gpuPass("points");
+
     double lastTime = glfwGetTime();
     int nbFrames = 0;
+    inputFrameStart = lastTime;
     do {
-        
+        // Sleeps until an event arrives unless a frame is already due.
+        frameScheduler.waitForFrame();
+        {
+            TRACE_SCOPE("input");
+            FrameProfiler::CpuScope scope(profiler, inputPhase);
+            processInput();
+        }
+        latency.poll();
+        if (curveWorker.frameReady())
+            frameScheduler.markDirty();
+        if (!frameScheduler.shouldDraw())
+            continue;
+        TRACE_SCOPE("frame");
+        profiler.beginFrame();
+
         // Timing
         double currentTime = glfwGetTime();
         nbFrames++;
         if (currentTime - lastTime >= 1.0){ // If last prinf() was more than 1sec ago
-            printf("%f ms/frame\n", 1000.0 / double(nbFrames));
+            printf("%f ms/frame, %zu segments (%zu samples) left to refine\n", 1000.0 * (currentTime - lastTime) / double(nbFrames),
+                   curveWorker.frame().pendingSegments, curveWorker.frame().pendingSamples);
             nbFrames = 0;
-            lastTime += 1.0;
+            lastTime = currentTime; // idle time is not spread over the next frames
         }
         
         
         glm::mat4 viewMatrix = glm::mat4(1.0f); // Identity matrix
-
+        glm::mat4 projectionMatrix = computeProjection(); // In world coordinates
         
-        if(currSelected >= 0){
-            // Dragging for P2aTask3
-            glm::vec3 worldPos = getWorldPosition(viewMatrix, projectionMatrix);
-            pointsObj->updatePoint(currSelected, worldPos);
+        if (curveDirty) {
+            TRACE_SCOPE("submit");
+            FrameProfiler::CpuScope scope(profiler, submitPhase);
+            submitCurve();
+            curveDirty = false;
         }
-        else if (glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT)){
-            // Draw picking for P2aTask2
-            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-            pointsObj->drawPicking(viewMatrix, projectionMatrix); // drawn in picking mode, the user will never see these colors
-            currSelected = getPickedIndex();
-            
-            if (currSelected >= 0) {
-                storedColor = pointsObj->getPointColor(currSelected);
-                pointsObj->setPointColor(currSelected, glm::vec3(1.0f, 1.0f, 1.0f));
+        {
+            TRACE_SCOPE("present");
+            profiler.beginCpu(presentPhase);
+            if (presentCurve()) {
+                profiler.recordCpu(workerPhase, curveWorker.frame().passMilliseconds);
+                profiler.recordMemory("worker_arena", curveWorker.frame().arenaHighWater);
             }
+            profiler.endCpu(presentPhase);
         }
-        //if(!glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT)){
-        //    currSelected = -1;
-        //} ^^ Uses glfw mouse callback instead of polling ^^
-        
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
         
         // DRAWING the SCENE
 
-        pointsObj->draw(viewMatrix, projectionMatrix);
+        {
+            TRACE_SCOPE("draw");
+            profiler.beginCpu(drawPhase);
+            profiler.beginGpu(fillPass);
+            fillObj->draw(viewMatrix, projectionMatrix);
+            profiler.endGpu(fillPass);
+            profiler.beginGpu(curvePass);
+            if (curveWorker.frame().gpuLines) // the frame on screen may predate the latest 'L'
+                lineObj->draw(viewMatrix, projectionMatrix);
+            else
+                strokeObj->draw(viewMatrix, projectionMatrix);
+            profiler.endGpu(curvePass);
+            // Points last so they blend over the curve.
+            profiler.beginGpu(pointsPass);
+            pointsObj->draw(viewMatrix, projectionMatrix);
+            profiler.endGpu(pointsPass);
+            profiler.endCpu(drawPhase);
+        }
         
         
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+        {
+            TRACE_SCOPE("swap");
+            profiler.beginCpu(swapPhase);
+            glfwSwapBuffers(window);
+            profiler.endCpu(swapPhase);
+        }
+        latency.swapped();
+        frameScheduler.frameDrawn();
+        frameArena.reset();
+        profiler.recordMemory("frame_arena", frameArena.highWater());
+        profiler.endFrame();
+        if (allocationCheckWarmup >= 0 && (int)inputFrame >= allocationCheckWarmup &&
+            profiler.lastFrameAllocations().allocations > 0) {
+            printf("Frame %u allocated %llu times (%llu bytes) after warm-up:\n", inputFrame,
+                   (unsigned long long)profiler.lastFrameAllocations().allocations,
+                   (unsigned long long)profiler.lastFrameAllocations().bytes);
+            profiler.printAllocations();
+            allocationCheckFailed = true;
+            glfwSetWindowShouldClose(window, GL_TRUE);
+        }
+        inputFrame++;
+        inputFrameStart = glfwGetTime();
 
-    } // Check if the ESC key was pressed or the window was closed
-    while (glfwGetKey(window, GLFW_KEY_ESCAPE) != GLFW_PRESS &&
-    glfwWindowShouldClose(window) == 0);
+    } // Check if the ESC key was pressed (processInput closes the window) or the window was closed
+    while (glfwWindowShouldClose(window) == 0);
 
+    curveWorker.stop();
+    inputRecorder.close();
+    profiler.writeJson(profilePath);
+    latency.writeJson(latencyPath);
+    if (!saveScenePath.empty()) {
+        SceneWriter writer;
+        writer.addCurve(points, colors, true);
+        writer.write(saveScenePath);
+    }
+    if (!tracePath.empty())
+        Trace::writeJson(tracePath);
+    delete fillObj;
+    delete lineObj;
+    delete strokeObj;
+    delete pointsObj;
+    profiler.release();
+    latency.release();
     glfwTerminate();
-    return 0;
+    return allocationCheckFailed ? 1 : 0;
 }
 
 // Initialize GLFW and create a window
@@ -117,7 +355,8 @@ int initWindow() {
         return -1;
     }
 
-    glfwWindowHint(GLFW_SAMPLES, 4);
+    // No multisampling: points, lines and strokes compute their own coverage.
+    glfwWindowHint(GLFW_SAMPLES, 0);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
@@ -142,31 +381,183 @@ int initWindow() {
     glfwSetInputMode(window, GLFW_STICKY_KEYS, GL_FALSE);
     glfwSetCursorPos(window, windowWidth / 2, windowHeight / 2);
     glfwSetMouseButtonCallback(window, mouseCallback);
+    glfwSetKeyCallback(window, keyCallback);
+    glfwSetScrollCallback(window, scrollCallback);
+    glfwSetCursorPosCallback(window, cursorPosCallback);
+    glfwSetWindowRefreshCallback(window, windowRefreshCallback);
+    glfwSetWindowSizeCallback(window, windowSizeCallback);
+    glfwSetWindowFocusCallback(window, windowFocusCallback);
     
     // Dark blue background
     glClearColor(0.0f, 0.0f, 0.4f, 0.0f);
     // Enable depth test
     glEnable(GL_DEPTH_TEST);
-    // Accept fragment if it closer to the camera than the former one
-    glDepthFunc(GL_LESS);
+    // Accept fragment if it is not behind the former one; the scene is flat, so later draws go on top
+    glDepthFunc(GL_LEQUAL);
     // Cull triangles which normal is not towards the camera
     glEnable(GL_CULL_FACE);
     // Make points big
     glPointSize(20.0f);
+    // Anti-aliased edges come out as alpha coverage
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
     
     return 0;
 }
 
 static void mouseCallback(GLFWwindow* window, int button, int action, int mods) {
-    if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS) {
+    double x_pos, y_pos;
+    glfwGetCursorPos(window, &x_pos, &y_pos);
+    InputEvent event = { InputEvent::MouseButton, button, action, mods, x_pos, y_pos, glfwGetTime() };
+    inputQueue.push(event);
+}
+
+static void scrollCallback(GLFWwindow* window, double xoffset, double yoffset) {
+    InputEvent event = { InputEvent::Scroll, 0, 0, 0, xoffset, yoffset, glfwGetTime() };
+    inputQueue.push(event);
+}
+
+static void cursorPosCallback(GLFWwindow* window, double x_pos, double y_pos) {
+    InputEvent event = { InputEvent::CursorPos, 0, 0, 0, x_pos, y_pos, glfwGetTime() };
+    inputQueue.push(event);
+}
+
+static void windowRefreshCallback(GLFWwindow* window) {
+    frameScheduler.markDirty();
+}
+
+static void windowSizeCallback(GLFWwindow* window, int width, int height) {
+    InputEvent event = { InputEvent::WindowSize, 0, 0, 0, (double)width, (double)height, glfwGetTime() };
+    inputQueue.push(event);
+}
+
+static void windowFocusCallback(GLFWwindow* window, int focused) {
+    frameScheduler.markDirty();
+}
+
+static void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+    InputEvent event = { InputEvent::Key, key, action, mods, 0.0, 0.0, glfwGetTime() };
+    inputQueue.push(event);
+}
+
+// Handles every queued event in arrival order, or during a replay the
+// recorded events of this frame, while live input other than ESC is dropped.
+void processInput() {
+    InputEvent event;
+    while (inputQueue.pop(event)) {
+        if (inputReplayer.isOpen()) {
+            if (event.type == InputEvent::Key && event.code == GLFW_KEY_ESCAPE)
+                glfwSetWindowShouldClose(window, GL_TRUE);
+            continue;
+        }
+        inputRecorder.record(event, inputFrame, inputFrameStart);
+        handleEvent(event);
+    }
+    if (!inputReplayer.isOpen())
+        return;
+    while (inputReplayer.next(inputFrame, inputFrameStart, event)) {
+        if (event.type == InputEvent::WindowSize)
+            glfwSetWindowSize(window, (int)event.x, (int)event.y);
+        handleEvent(event);
+    }
+    if (inputReplayer.finished())
+        glfwSetWindowShouldClose(window, GL_TRUE);
+}
+
+// Each cursor event moves the dragged point or the view, so none of the
+// motion between frames is lost.
+void handleEvent(const InputEvent& event) {
+    glm::mat4 viewMatrix = glm::mat4(1.0f);
+    switch (event.type) {
+    case InputEvent::MouseButton:
+        if (event.code == GLFW_MOUSE_BUTTON_LEFT && event.action == GLFW_PRESS && currSelected < 0) {
+            // Draw picking for P2aTask2
+            TRACE_SCOPE("picking");
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            pointsObj->drawPicking(viewMatrix, computeProjection()); // drawn in picking mode, the user will never see these colors
+            currSelected = getPickedIndex(event.x, event.y);
+            if (currSelected >= 0) {
+                storedColor = pointsObj->getPointColor(currSelected);
+                pointsObj->setPointColor(currSelected, glm::vec3(1.0f, 1.0f, 1.0f));
+                latency.beginDrag();
+            }
+        }
+        else if (event.code == GLFW_MOUSE_BUTTON_LEFT && event.action == GLFW_RELEASE && currSelected >= 0) {
+            pointsObj->setPointColor(currSelected, storedColor); // restore color
+            currSelected = -1;
+            latency.endDrag();
+        }
+        else if (event.code == GLFW_MOUSE_BUTTON_RIGHT) {
+            panning = event.action == GLFW_PRESS;
+            panLastX = event.x;
+            panLastY = event.y;
+        }
+        cursorX = event.x;
+        cursorY = event.y;
+        frameScheduler.markDirty();
+        break;
+
+    case InputEvent::CursorPos:
+        cursorX = event.x;
+        cursorY = event.y;
+        if (panning) {
+            viewCenter -= glm::vec2(event.x - panLastX, panLastY - event.y) * worldPerPixel;
+            panLastX = event.x;
+            panLastY = event.y;
+            curveDirty = true;
+            frameScheduler.markDirty();
+        }
+        if (currSelected >= 0) {
+            // Dragging for P2aTask3
+            glm::vec3 worldPos = getWorldPosition(event.x, event.y, viewMatrix, computeProjection());
+            pointsObj->updatePoint(currSelected, worldPos);
+            points[currSelected] = worldPos;
+            latency.inputHandled(event.time);
+            curveDirty = true;
+            frameScheduler.markDirty();
+        }
+        break;
+
+    case InputEvent::Scroll: {
+        // Zoom by 10% per wheel step, keeping the world point under the cursor fixed.
+        glm::vec2 ndc(2.0f * (float)cursorX / windowWidth - 1.0f, 1.0f - 2.0f * (float)cursorY / windowHeight);
+        glm::vec2 halfExtent(viewHalfWidth, viewHalfHeight);
+        glm::vec2 anchor = viewCenter + ndc * halfExtent / viewZoom;
+
+        viewZoom = glm::clamp(viewZoom * powf(1.1f, (float)event.y), 0.01f, 10000.0f);
+        viewCenter = anchor - ndc * halfExtent / viewZoom;
+        curveDirty = true; // the CPU stroke width is in world units
+        frameScheduler.markDirty();
+        break;
     }
-    else if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_RELEASE && currSelected >= 0) {
-        pointsObj->setPointColor(currSelected, storedColor); // restore color
-        currSelected = -1;
+
+    case InputEvent::Key:
+        if (event.action != GLFW_PRESS)
+            break;
+        if (event.code == GLFW_KEY_ESCAPE) {
+            glfwSetWindowShouldClose(window, GL_TRUE);
+        }
+        else if (event.code == GLFW_KEY_L) {
+            useGpuLines = !useGpuLines;
+            curveDirty = true;
+        }
+        else if (event.code == GLFW_KEY_F) {
+            fillObj->setFillRule(fillObj->getFillRule() == FillRule::NonZero ? FillRule::EvenOdd : FillRule::NonZero);
+        }
+        else if (event.code == GLFW_KEY_C && !inputReplayer.isOpen()) { // replays always run continuously
+            bool continuous = frameScheduler.getMode() == FrameScheduler::Mode::Continuous;
+            frameScheduler.setMode(continuous ? FrameScheduler::Mode::OnDemand : FrameScheduler::Mode::Continuous);
+        }
+        frameScheduler.markDirty();
+        break;
+
+    case InputEvent::WindowSize:
+        frameScheduler.markDirty();
+        break;
     }
 }
 
-int getPickedIndex(){ // colors are drawn in the picking mode
+int getPickedIndex(double x_pos, double y_pos){ // colors are drawn in the picking mode
     glFlush();
     // --- Wait until all the pending drawing commands are really done.
     // Ultra-mega-over slow !
@@ -179,8 +570,7 @@ int getPickedIndex(){ // colors are drawn in the picking mode
     unsigned char data[4];
 
     //TODO: P2aTask2 - Use glfwGetCursorPos to get the x and y value of the cursor.
-    double x_pos, y_pos;
-    glfwGetCursorPos(window, &x_pos, &y_pos);
+    // The position comes from the input event, in the same window coordinates as glfwGetCursorPos.
     y_pos = windowHeight - y_pos; // Flip y position as glfwGetCursorPos gives the cursor position relative to top left of the screen.
     //TODO: P2aTask2 - Use glfwGetFramebufferSize and glfwGetWindowSize to get the frame buffer size and window size. On high resolution displays, these sizes might be different.
     glReadPixels(x_pos, y_pos, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, data);
@@ -191,11 +581,9 @@ int getPickedIndex(){ // colors are drawn in the picking mode
     int pickedId = data[0] - 1;
     return pickedId;
 }
-glm::vec3 getWorldPosition(const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix) {
+glm::vec3 getWorldPosition(double x_pos, double y_pos, const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix) {
     
     //TODO: P2aTask3 - Use glfwGetFramebufferSize and glfwGetWindowSize to get the frame buffer size and window size. On high resolution displays, these sizes might be different.
-    double x_pos, y_pos;
-    glfwGetCursorPos(window, &x_pos, &y_pos);
     y_pos = windowHeight - y_pos; // Flip y position as glfwGetCursorPos gives the cursor position relative to top left of the screen.
     //TODO: P2aTask2 - Use glfwGetCursorPos to get the x and y value of the cursor.
     // Note that y position has to be flipped as glfwGetCursorPos gives the cursor position relative to top left of the screen. The read location must also be multiplied by (buffer size / windowSize) for some displays.
@@ -210,3 +598,52 @@ glm::vec3 getWorldPosition(const glm::mat4& viewMatrix, const glm::mat4& project
     
     return worldPos;
 }
+
+glm::mat4 computeProjection() {
+    worldPerPixel = 2.0f * viewHalfWidth / (windowWidth * viewZoom);
+    glm::vec2 halfExtent = glm::vec2(viewHalfWidth, viewHalfHeight) / viewZoom;
+    return glm::ortho(viewCenter.x - halfExtent.x, viewCenter.x + halfExtent.x,
+                      viewCenter.y - halfExtent.y, viewCenter.y + halfExtent.y, 0.0f, 100.0f);
+}
+
+// Hands the points and the view to the curve worker.
+void submitCurve() {
+    static CurveInput input; // reused so submitting does not allocate
+    // Grow the view by the stroke so segments just off-screen still draw their edge.
+    glm::vec2 margin = glm::vec2(strokeWidthPixels * worldPerPixel);
+    glm::vec2 halfExtent = glm::vec2(viewHalfWidth, viewHalfHeight) / viewZoom;
+    input.points.assign(points.begin(), points.end());
+    input.viewMin = viewCenter - halfExtent - margin;
+    input.viewMax = viewCenter + halfExtent + margin;
+    input.worldPerPixel = worldPerPixel;
+    input.strokeWidthPixels = strokeWidthPixels;
+    input.gpuLines = useGpuLines;
+    input.sequence = ++curveSequence;
+    curveWorker.submit(input);
+    latency.submitted(input.sequence);
+}
+
+// Uploads the newest frame from the curve worker, if there is one. Fill hulls
+// are re-uploaded only for segments that changed since the last upload.
+bool presentCurve() {
+    if (!curveWorker.acquireFrame())
+        return false;
+    const CurveFrame& frame = curveWorker.frame();
+    if (fillRevisions.size() != frame.segments.size()) {
+        fillObj->setSegments(frame.segments);
+        fillRevisions = frame.segmentRevisions;
+    } else {
+        for (size_t i = 0; i < frame.segments.size(); ++i) {
+            if (fillRevisions[i] == frame.segmentRevisions[i])
+                continue;
+            fillObj->updateSegment((int)i, frame.segments[i]);
+            fillRevisions[i] = frame.segmentRevisions[i];
+        }
+    }
+    if (frame.gpuLines)
+        lineObj->upload(frame.polyline, frame.runs);
+    else
+        strokeObj->upload(frame.strokeVertices, frame.strokeEdges);
+    latency.presented(frame.inputSequence);
+    return true;
+}
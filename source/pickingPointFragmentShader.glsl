@@ -4,6 +4,8 @@ flat in vec3 pickColor;
 out vec4 finalColor;
 
 void main() {
+    // Same round footprint as the visible sprite, but hard edged so ids never blend.
+    if (length(gl_PointCoord - vec2(0.5)) > 0.5)
+        discard;
     finalColor = vec4(pickColor, 1.0);
 }
-
@@ -5,6 +5,11 @@ out vec4 finalColor;
 
 
 void main() {
-    finalColor = vec4(fragColor, 1.0);
+    // Round sprite: distance from the sprite centre, 1.0 on the rim.
+    float dist = length(gl_PointCoord - vec2(0.5)) * 2.0;
+    // One pixel wide ramp across the rim instead of multisampling.
+    float coverage = clamp((1.0 - dist) / fwidth(dist) + 0.5, 0.0, 1.0);
+    if (coverage <= 0.0)
+        discard;
+    finalColor = vec4(fragColor, coverage);
 }
-
@@ -0,0 +1,12 @@
+#version 330 core
+
+in float edgeCoord; // -1 on the right edge, +1 on the left edge of the stroke
+
+uniform vec3 strokeColor;
+out vec4 finalColor;
+
+void main() {
+    // Distance to the nearer edge in pixels, via the screen-space rate of change.
+    float coverage = clamp((1.0 - abs(edgeCoord)) / fwidth(edgeCoord), 0.0, 1.0);
+    finalColor = vec4(strokeColor, coverage);
+}
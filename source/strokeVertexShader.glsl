@@ -0,0 +1,13 @@
+#version 330 core
+
+layout(location = 0) in vec3 position;
+layout(location = 1) in float edge;
+
+uniform mat4 MVP;
+
+out float edgeCoord;
+
+void main() {
+    gl_Position = MVP * vec4(position, 1.0);
+    edgeCoord = edge;
+}